@@ -0,0 +1,46 @@
+﻿// BlockLink 块大小( 64 / 256 / 1024 ) 对 遍历 的 影响. 不参与 xx 库 编译 ( 见 CMakeLists.txt )
+// build: g++ -std=c++20 -O2 -I. _bench_blocklink.cpp
+#include "xx_string.h"
+#include "xx_blocklink.h"
+#include <random>
+
+struct E {
+	float x, y, vx, vy;
+	int hp;
+	char pad[44];
+};
+
+// 100k 个, 随机删 30k 造 空洞, 然后 每帧 遍历 更新 位置
+template<size_t blockSize>
+double Bench(int numFrames = 200) {
+	xx::BlockLinkN<E, xx::BlockLinkVIT, blockSize> bl;
+	std::mt19937 rng(1);
+	std::vector<xx::BlockLinkWeak<E, xx::BlockLinkVIT>> ws;
+	for (int i = 0; i < 100000; ++i) {
+		ws.push_back(bl.WeakEmplace(E{ 1, 2, 0.1f, 0.2f, 10 }));
+	}
+	for (int i = 0; i < 30000; ++i) {
+		bl.Remove(ws[rng() % ws.size()]);
+	}
+	float acc{};
+	auto b = std::chrono::steady_clock::now();
+	for (int f = 0; f < numFrames; ++f) {
+		bl.ForeachFlags([&](E& e) {
+			e.x += e.vx;
+			e.y += e.vy;
+			acc += e.x;
+		});
+	}
+	auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - b).count();
+	volatile float sink = acc;
+	(void)sink;
+	return secs;
+}
+
+int main() {
+	auto s64 = Bench<64>();
+	auto s256 = Bench<256>();
+	auto s1024 = Bench<1024>();
+	printf("BlockLink ForeachFlags 100k ( 30k holes ) x 200 frames: 64: %.3fs  256: %.3fs  1024: %.3fs\n", s64, s256, s1024);
+	return 0;
+}
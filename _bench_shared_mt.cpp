@@ -0,0 +1,23 @@
+﻿// Shared ( 非原子 计数 ) 与 SharedMT ( 原子 计数 ) 的 复制 + 释放 开销 对比. 不参与 xx 库 编译 ( 见 CMakeLists.txt )
+// build: g++ -std=c++20 -O2 -I. _bench_shared_mt.cpp
+#include "xx_ptr.h"
+#include "xx_ptr_mt.h"
+
+template<typename P>
+double Bench(P const& p, int n = 20000000) {
+	void* volatile sink{};
+	auto b = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i) {
+		P q = p;
+		sink = q.pointer;
+	}
+	(void)sink;
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - b).count();
+}
+
+int main() {
+	auto s = Bench(xx::MakeShared<int>());
+	auto smt = Bench(xx::MakeSharedMT<int>());
+	printf("copy + release x 20M: Shared: %.3fs  SharedMT: %.3fs\n", s, smt);
+	return 0;
+}
@@ -0,0 +1,36 @@
+﻿// Task 创建 + 执行完毕 的 平均耗时. 定义 XX_TASK_USE_POOL 时 协程帧 走 TaskFramePool, 并 打印 池 计数. 不参与 xx 库 编译 ( 见 CMakeLists.txt )
+// build: g++ -std=c++20 -O2 -I. _bench_task.cpp
+//        g++ -std=c++20 -O2 -I. -DXX_TASK_USE_POOL _bench_task.cpp
+#include "xx_string.h"
+#include "xx_task.h"
+
+xx::Task<int> Sub(int i) {
+	co_yield 0;
+	co_return i * 2;
+}
+
+int main() {
+	static constexpr int numFrames = 2000, numPerFrame = 500;
+	xx::Tasks tasks;
+	int64_t sum{};
+	auto b = std::chrono::steady_clock::now();
+	for (int f = 0; f < numFrames; ++f) {
+		for (int i = 0; i < numPerFrame; ++i) {
+			tasks.Add([](int64_t& sum, int i)->xx::Task<> {
+				sum += co_await Sub(i);
+			}(sum, i));
+		}
+		tasks();
+	}
+	while (tasks.Count()) {
+		tasks();
+	}
+	auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - b).count();
+	printf("sum %lld  %.1f ns per spawn + complete\n", (long long)sum, ns / (numFrames * numPerFrame));
+#ifdef XX_TASK_USE_POOL
+	auto& c = xx::TaskFramePool::GetCounters();
+	printf("allocs %lld hits %lld frees %lld bigs %lld cachedBytes %lld\n"
+		, (long long)c.allocs, (long long)c.hits, (long long)c.frees, (long long)c.bigs, (long long)c.cachedBytes);
+#endif
+	return 0;
+}
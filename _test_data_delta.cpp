@@ -0,0 +1,73 @@
+﻿// WriteDelta / ReadDelta 检查: 往返 还原, 以及 伪造 / 截断 的 数据 返回 错误 而 不是 超大分配 或 越界. 不参与 xx 库 编译 ( 见 CMakeLists.txt )
+// build: g++ -std=c++20 -O2 -I. _test_data_delta.cpp && ./a.out    ( 失败时 返回 非 0 )
+#include "xx_string.h"
+#include "xx_data_delta.h"
+
+static int gFails{};
+#define CHECK(x) do { if (!(x)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #x); ++gFails; } } while (0)
+
+static bool RoundTrip(std::string const& base, std::string const& cur) {
+	xx::Data d;
+	xx::WriteDelta(d, xx::Span(base.data(), base.size()), xx::Span(cur.data(), cur.size()));
+	xx::Data_r dr(d.buf, d.len);
+	xx::Data out;
+	if (xx::ReadDelta(dr, xx::Span(base.data(), base.size()), out)) return false;
+	return dr.offset == d.len && std::string_view((char*)out.buf, out.len) == cur;
+}
+
+int main() {
+	// 往返
+	{
+		std::string a(1000, 'a'), b = a;
+		b[10] = 'x';
+		b[500] = 'y';
+		CHECK(RoundTrip(a, b));
+		CHECK(RoundTrip(a, ""));
+		CHECK(RoundTrip("", a));
+		CHECK(RoundTrip(a, a + "tail"));
+		CHECK(RoundTrip(a + "tail", a));
+		CHECK(RoundTrip("", std::string(100000, '\0')));       // base 之外 的 0 几乎 不占 差异字节
+	}
+	// 伪造 长度: 不分配, 返回 错误
+	{
+		xx::Data d;
+		d.WriteVarInteger((size_t)1 << 40);
+		d.WriteFixed((uint8_t)0);
+		d.WriteFixed((uint8_t)0);
+		CHECK(d.len < 16);
+		xx::Data_r dr(d.buf, d.len);
+		xx::Data out;
+		CHECK(xx::ReadDelta(dr, {}, out) != 0);
+		CHECK(out.cap == 0);
+	}
+	// 自定义 maxLen
+	{
+		std::string a(100, 'a');
+		xx::Data d;
+		xx::WriteDelta(d, {}, xx::Span(a.data(), a.size()));
+		xx::Data_r dr(d.buf, d.len);
+		xx::Data out;
+		CHECK(xx::ReadDelta(dr, {}, out, 99) != 0);
+		dr.offset = 0;
+		CHECK(xx::ReadDelta(dr, {}, out, 100) == 0);
+	}
+	// 段 越界 / 截断
+	{
+		xx::Data d;
+		d.WriteVarInteger((size_t)4);
+		d.WriteVarInteger((size_t)2);
+		d.WriteVarInteger((size_t)3);                         // 2 + 3 > 4
+		d.WriteBuf("abc", 3);
+		d.WriteFixed((uint8_t)0);
+		d.WriteFixed((uint8_t)0);
+		xx::Data_r dr(d.buf, d.len);
+		xx::Data out;
+		CHECK(xx::ReadDelta(dr, {}, out) != 0);
+		for (size_t len = 0; len < d.len; ++len) {
+			xx::Data_r dr2(d.buf, len);
+			CHECK(xx::ReadDelta(dr2, {}, out) != 0);
+		}
+	}
+	printf(gFails ? "failed\n" : "ok\n");
+	return gFails;
+}
@@ -0,0 +1,108 @@
+﻿// PtrPool 检查: 大块 只多 隐藏头, 不走 64K 对齐分配; 小块 复用; 基类 Shared 释放 派生类 大块; 线程退出后 的 分配 / 释放. 不参与 xx 库 编译 ( 见 CMakeLists.txt )
+// build: g++ -std=c++20 -O2 -I. _test_ptr_pool.cpp && ./a.out    ( 失败时 返回 非 0 )
+#define XX_PTR_USE_POOL
+#include "xx_ptr.h"
+
+// 统计 全局 new 的 字节数 与 对齐分配 次数
+inline std::atomic<size_t> gNewBytes, gAlignedNews;
+
+void* operator new(size_t siz) {
+	gNewBytes += siz;
+	if (auto p = std::malloc(siz)) return p;
+	throw std::bad_alloc();
+}
+void* operator new(size_t siz, std::align_val_t a) {
+	gNewBytes += siz;
+	++gAlignedNews;
+	if (auto p = std::aligned_alloc((size_t)a, (siz + (size_t)a - 1) & ~((size_t)a - 1))) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+static int gFails{};
+#define CHECK(x) do { if (!(x)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #x); ++gFails; } } while (0)
+
+struct Big {
+	char buf[1100];
+};
+
+struct Base {
+	int x{};
+	virtual ~Base() {}
+};
+struct Derived : Base {
+	char buf[3000];
+};
+
+struct alignas(64) Aligned {
+	int x;
+};
+
+// 在 PtrPool 的 ThreadCache 之前 构造, 故 在其 之后 析构
+struct LateUser {
+	~LateUser() {
+		auto s = xx::MakeShared<int>(1);
+		xx::Weak<int> w = s;
+		s.Reset();
+		if (w) abort();
+	}
+};
+
+int main() {
+	// 大块 的 占用 = 对象 + 隐藏头
+	{
+		auto b0 = gNewBytes.load(), a0 = gAlignedNews.load();
+		auto bigs = xx::PtrPool::GetCounters().bigs;
+		auto s = xx::MakeShared<Big>();
+		auto used = gNewBytes - b0;
+		printf("Shared<Big> ( %zu bytes header ) footprint: %zu\n", sizeof(xx::PtrHeader<Big>), used);
+		CHECK(used <= sizeof(xx::PtrHeader<Big>) + xx::PtrPool::step);
+		CHECK(gAlignedNews == a0);
+		CHECK(xx::PtrPool::GetCounters().bigs == bigs + 1);
+	}
+	// 小块 复用, 不再 new
+	{
+		{ auto s = xx::MakeShared<int>(1); }
+		auto b0 = gNewBytes.load();
+		for (int i = 0; i < 1000; ++i) {
+			auto s = xx::MakeShared<int>(i);
+			CHECK(*s == i);
+		}
+		CHECK(gNewBytes == b0);
+	}
+	// 基类 Shared 释放 派生类 大块; Weak 延长 块 的 寿命
+	{
+		xx::Shared<Base> s = xx::MakeShared<Derived>();
+		xx::Weak<Base> w = s;
+		s.Reset();
+		CHECK(!w);
+	}
+	// 对齐
+	{
+		std::vector<xx::Shared<Aligned>> ss;
+		for (int i = 0; i < 100; ++i) {
+			ss.push_back(xx::MakeShared<Aligned>());
+			CHECK(((size_t)ss.back().pointer & 63) == 0);
+		}
+		ss.clear();
+		for (int i = 0; i < 100; ++i) {
+			ss.push_back(xx::MakeShared<Aligned>());
+			CHECK(((size_t)ss.back().pointer & 63) == 0);
+		}
+	}
+	// 线程退出 过程中 分配 / 释放, 以及 跨线程 释放
+	{
+		xx::Shared<int> s;
+		std::thread([&] {
+			thread_local LateUser lu;
+			s = xx::MakeShared<int>(2);
+		}).join();
+		CHECK(*s == 2);
+		s.Reset();
+	}
+	printf(gFails ? "failed\n" : "ok\n");
+	return gFails;
+}
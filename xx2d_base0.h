@@ -211,6 +211,23 @@ namespace xx {
             return d;
         }
 
+        // read data by full path, pass to f(Span const&) chunk by chunk. zstd content will be stream decompressed ( no need whole output buffer / content size )
+        template<typename F>
+        void ForeachFileChunkWithFullPath(std::string_view const& fp, F&& f) {
+            Data d;
+            if (int r = ReadAllBytes((std::u8string_view&)fp, d)) {
+                CoutN("file read error. r = ", r, ", fn = ", fp);
+                xx_assert(false);
+            }
+            if (d.len >= 4 && d[0] == 0x28 && d[1] == 0xB5 && d[2] == 0x2F && d[3] == 0xFD) {	// zstd
+                ZstdDStream ds;
+                ds.Feed(d, f);
+                xx_assert(ds.IsDone());
+            } else if (d.len) {
+                f(Span(d.buf, d.len));
+            }
+        }
+
         // read all data by GetFullPath( fn )
         template<bool returnFullPath = true, bool autoDecompress = false>
         auto LoadFileData(std::string_view const& fn) {
@@ -33,6 +33,15 @@ namespace xx {
                 + " UPS:" + std::to_string((uint32_t)ups)
                 + " DC:" + std::to_string(Shader::drawCall)
                 + " VC:" + std::to_string(Shader::drawVerts);
+#ifdef XX_PTR_CENSUS
+            PtrCensus::NextFrame();
+            s += " SA:" + std::to_string(PtrCensus::GetLastFrameAllocs())      // Shared allocs last frame
+                + " SL:" + std::to_string(PtrCensus::GetLive());               // Shared live
+#endif
+#ifdef XX_TASK_PROFILE
+            TaskProfiler::NextFrame();
+            s += " TR:" + std::to_string(int64_t(TaskProfiler::GetLastFrameTotal() * 1000000));    // Tasks resume us last frame
+#endif
 
             eb.GLBlendFunc<false>(eb.blendDefault);
             ctc.Draw({ -eb.windowSize_2.x, -eb.windowSize_2.y }, s, RGBA8_Green, { 0, 0 });
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "xx_list.h"
+#include "xx_workers.h"
 
 namespace xx {
 
@@ -119,12 +120,20 @@ namespace xx {
 	};
 
 
-	template<typename T, template<typename...> typename Node, bool isDoubleLink = HasMember_prev<Node<T>>&& HasMember_next<Node<T>>, bool enableFlags = !isDoubleLink>
+	template<typename NT>
+	constexpr bool BlockLinkIsDoubleLink_v = HasMember_prev<NT> && HasMember_next<NT>;
+
+	// blockSize: 每块 节点数( 2^n ). 大 T 用小块, 小 T 大量遍历 用大块
+	template<typename T, template<typename...> typename Node, bool isDoubleLink = BlockLinkIsDoubleLink_v<Node<T>>, bool enableFlags = !isDoubleLink, size_t blockSize = 64>
 	struct BlockLink;
 
-	template<typename T, template<typename...> typename Node>
+	// 只改 块大小 时 用这个( 免写 isDoubleLink, enableFlags )
+	template<typename T, template<typename...> typename Node, size_t blockSize>
+	using BlockLinkN = BlockLink<T, Node, BlockLinkIsDoubleLink_v<Node<T>>, !BlockLinkIsDoubleLink_v<Node<T>>, blockSize>;
+
+	template<typename T, template<typename...> typename Node, size_t blockSize = 64>
 	struct BlockLinkHolder {
-		using OT = BlockLink<T, Node>;
+		using OT = BlockLinkN<T, Node, blockSize>;
 		using WT = BlockLinkWeak<T, Node>;
 
 		OT* owner{};
@@ -186,29 +195,34 @@ namespace xx {
 		}
 	};
 
-	template<typename NT>
+	template<typename NT, size_t blockSize>
 	struct BlockLinkBlock {
-		std::array<NT, 64> buf;
+		std::array<NT, blockSize> buf;
 	};
 
-	template<typename NT>
+	template<typename NT, size_t blockSize>
 	struct BlockLinkBlockWithFlags {
-		uint64_t flags;
-		std::array<NT, 64> buf;
+		std::array<uint64_t, (blockSize + 63) / 64> flags;		// bit set: 1 == 在用
+		std::array<NT, blockSize> buf;
 	};
 
 
-	template<typename T, template<typename...> typename Node = BlockLinkVIT, bool isDoubleLink, bool enableFlags>
+	template<typename T, template<typename...> typename Node = BlockLinkVIT, bool isDoubleLink, bool enableFlags, size_t blockSize>
 	struct BlockLink : std::conditional_t<isDoubleLink, BlockLinkBase_VINP, BlockLinkBase_VI> {
 		using NodeType = Node<T>;
 
+		static_assert(blockSize >= 8 && std::has_single_bit(blockSize));
+		static constexpr int32_t blockShift = std::countr_zero(blockSize);
+		static constexpr int32_t blockMask = int32_t(blockSize - 1);
+		static constexpr size_t numFlagWords = (blockSize + 63) / 64;
+
 		static_assert(HasMember_version<Node<T>>);
 		static_assert(HasMember_index<Node<T>>);
 		static_assert(!HasMember_typeId<Node<T>> || HasMemberType_cTypeId<T>);
 
-		using Block = std::conditional_t<isDoubleLink, BlockLinkBlock<Node<T>>, BlockLinkBlockWithFlags<Node<T>>>;
+		using Block = std::conditional_t<enableFlags, BlockLinkBlockWithFlags<Node<T>, blockSize>, BlockLinkBlock<Node<T>, blockSize>>;
 
-		using HolderType = BlockLinkHolder<T, Node>;
+		using HolderType = BlockLinkHolder<T, Node, blockSize>;
 		using WeakType = BlockLinkWeak<T, Node>;
 
 		BlockLink() = default;
@@ -231,7 +245,17 @@ namespace xx {
 		void Clear() {
 			if constexpr (!(std::is_standard_layout_v<T> && std::is_trivial_v<T>)) {
 				if constexpr (isDoubleLink) {
-					ForeachLink([](auto&) { return ForeachResult::RemoveAndContinue; });
+					// 按 下标 扫( 含 Detach 过的 节点 )
+					for (int32_t i = 0; i < this->len; ++i) {
+						auto& o = RefNode(i);
+						if (o.version < -2) {
+							o.value.~T();
+							o.version = -2;
+							if constexpr (enableFlags) {
+								FlagSet<false>(i);
+							}
+						}
+					}
 				} else {
 					ForeachFlags<true>([](auto&){});
 				}
@@ -256,6 +280,36 @@ namespace xx {
 			}
 		}
 
+		// foreach used index by flags. f(Block&, int32_t index) return false: break
+		// 按位 跳过 空闲节点, 预取 下一块. 每次 重读 flags( 回调中 可能 增删 ), 只取 当前位 之后的
+		template<typename F>
+		XX_INLINE void ForeachFlagsIndex(F&& f) requires enableFlags {
+			for (int32_t i = 0, n = this->blocks.len - 1; i <= n; ++i) {
+				auto& block = *(Block*)this->blocks[i];
+				if (i < n) {
+					XX_PREFETCH(this->blocks[i + 1]);
+				}
+				for (size_t k = 0; k < numFlagWords; ++k) {
+					auto& flags = block.flags[k];
+					for (auto w = flags; w;) {
+						auto j = std::countr_zero(w);
+						if (!f(block, (i << blockShift) + int32_t(k * 64 + j))) return;
+						w = j == 63 ? 0 : flags & (~uint64_t(0) << (j + 1));
+					}
+				}
+			}
+		}
+
+		// foreach node by flags. f(Node<T>&) return false: break
+		template<typename F>
+		XX_INLINE void ForeachFlagsNode(F&& f) requires enableFlags {
+			ForeachFlagsIndex([&](Block& block, int32_t index) {
+				auto& o = block.buf[index & blockMask];
+				assert(o.version < -2);
+				return f(o);
+			});
+		}
+
 		// foreach by flags
 		// .ForeachFlags( [](T& o)->void {    } );
 		// .ForeachFlags( [](T& o)->xx::ForeachResult {    } );
@@ -263,44 +317,30 @@ namespace xx {
 		void ForeachFlags(F&& func) requires enableFlags {
 			if (this->len <= 0) return;
 
-			for (int32_t i = 0, n = this->blocks.len - 1; i <= n; ++i) {
-
-				auto& block = *(Block*)this->blocks[i];
-				auto& flags = block.flags;
-				if (!flags) continue;
-
-				auto left = this->len & 0b111111;
-				int32_t e = (i < n || !left) ? 64 : left;
-				for (int32_t j = 0; j < e; ++j) {
-					auto& o = block.buf[j];
-					auto bit = uint64_t(1) << j;
-					if ((flags & bit) == 0) {
-						assert(o.version >= -2);
-						continue;
-					}
-					assert(o.version < -2);
-
-					if constexpr (callByClear) {
-						o.value.~T();
-						o.version = -2;		// for weak check
-					} else if constexpr (std::is_void_v<R>) {
-						func(o.value);
-					} else {
-						auto r = func(o.value);
-						switch (r) {
-						case ForeachResult::Continue: break;
-						case ForeachResult::RemoveAndContinue:
-							Free(o);
-							break;
-						case ForeachResult::Break: return;
-						case ForeachResult::RemoveAndBreak:
-							Free(o);
-							return;
-						}
+			ForeachFlagsNode([&](Node<T>& o) {
+				if constexpr (callByClear) {
+					o.value.~T();
+					o.version = -2;		// for weak check
+				} else if constexpr (std::is_void_v<R>) {
+					func(o.value);
+				} else {
+					auto r = func(o.value);
+					switch (r) {
+					case ForeachResult::Continue: break;
+					case ForeachResult::RemoveAndContinue:
+						Free(o);
+						break;
+					case ForeachResult::Break: return false;
+					case ForeachResult::RemoveAndBreak:
+						Free(o);
+						return false;
 					}
 				}
-				if constexpr (callByClear) {
-					flags = 0;
+				return true;
+			});
+			if constexpr (callByClear) {
+				for (auto& b : this->blocks) {
+					((Block*)b)->flags = {};
 				}
 			}
 		}
@@ -319,6 +359,9 @@ namespace xx {
 			}
 			for (int32_t idx = beginIdx; idx != -1;) {
 				auto& o = RefNode(idx);
+				if (auto nx = fromHead ? o.next : o.prev; nx != -1) {
+					XX_PREFETCH(NodeAt(nx));		// 下一个节点 可能在 别的块
+				}
 				if constexpr (std::is_void_v<R>) {
 					func(o.value);
 				} else {
@@ -342,10 +385,219 @@ namespace xx {
 			}
 		}
 
+		// 并行遍历: 按块 分片 交给 ws ( 调用者线程 也参与 ). 顺序 不定; func 中 只可 修改 元素自身, 不可 增删
+		// func 返回 Remove* 时 只记录( 每分片 一个缓冲 ), 全部完成后 按 分片 顺序( 即 下标 升序 ) 统一删除, 结果 与 线程数 无关. Break 让 所有分片 尽快停止
+		// .ForeachParallel( ws, [](T& o)->void {    } );
+		// .ForeachParallel( ws, [](T& o)->xx::ForeachResult {    } );
+		template<typename F, typename R = std::invoke_result_t<F, T&>>
+		void ForeachParallel(Workers& ws, F&& func, int32_t blocksPerTask = 1) {
+			if (this->len <= 0) return;
+			assert(blocksPerTask > 0);
+			auto numBlocks = (this->len + blockMask) >> blockShift;
+			auto numTasks = (numBlocks + blocksPerTask - 1) / blocksPerTask;
+			std::vector<Listi32<int32_t>> removes;
+			if constexpr (!std::is_void_v<R>) {
+				removes.resize(numTasks);
+			}
+			std::atomic<bool> stop{};
+
+			ws.ParallelFor(numTasks, [&](int32_t t) {
+				// 返回 false 表示 停止
+				auto visit = [&](int32_t index, Node<T>& o) {
+					if constexpr (std::is_void_v<R>) {
+						func(o.value);
+					} else {
+						if (stop.load(std::memory_order_relaxed)) return false;
+						auto r = func(o.value);
+						switch (r) {
+						case ForeachResult::Continue: break;
+						case ForeachResult::RemoveAndContinue:
+							removes[t].Emplace(index);
+							break;
+						case ForeachResult::Break:
+							stop.store(true, std::memory_order_relaxed);
+							return false;
+						case ForeachResult::RemoveAndBreak:
+							removes[t].Emplace(index);
+							stop.store(true, std::memory_order_relaxed);
+							return false;
+						}
+					}
+					return true;
+				};
+				for (int32_t i = t * blocksPerTask, e = std::min(i + blocksPerTask, numBlocks); i < e; ++i) {
+					auto& block = *(Block*)this->blocks[i];
+					if constexpr (enableFlags) {
+						for (size_t k = 0; k < numFlagWords; ++k) {
+							for (auto w = block.flags[k]; w; w &= w - 1) {
+								auto j = int32_t(k * 64) + std::countr_zero(w);
+								if (!visit((i << blockShift) + j, block.buf[j])) return;
+							}
+						}
+					} else {
+						for (int32_t j = 0, je = std::min((int32_t)blockSize, this->len - (i << blockShift)); j < je; ++j) {
+							auto& o = block.buf[j];
+							if (o.version < -2) {
+								if (!visit((i << blockShift) + j, o)) return;
+							}
+						}
+					}
+				}
+			});
+
+			if constexpr (!std::is_void_v<R>) {
+				for (auto& rs : removes) {
+					for (auto index : rs) {
+						Free(RefNode(index));
+					}
+				}
+			}
+		}
+
+		// Compact 的结果: 旧下标 -> 新下标. 用于 修正 BlockLinkVI / BlockLinkWeak ( version 不变, 只改 下标 / 指针 )
+		struct Remap {
+			Listi32<int32_t> idxs;								// 旧下标 -> 新下标( -1: 原本就是空位 )
+			Listi32<void*> blocks;								// 整理前的 块( 前面的 块 依旧在用, 后面的 可能已释放, 只用于 算地址 )
+			std::vector<std::pair<size_t, int32_t>> sorted;		// 块地址 排序, 用于 按 指针 查 旧下标
+
+			XX_INLINE int32_t operator[](int32_t oldIndex) const {
+				return oldIndex >= 0 && oldIndex < idxs.len ? idxs[oldIndex] : -1;
+			}
+
+			// 返回 false: 指向的 已不存在( vi 被置为 默认值 )
+			bool Fix(BlockLinkVI& vi) const {
+				if (auto n = operator[](vi.index); n >= 0) {
+					vi.index = n;
+					return true;
+				}
+				vi = {};
+				return false;
+			}
+
+			bool Fix(WeakType& w) const {
+				if (!w.pointer) return false;
+				auto p = (size_t)container_of(w.pointer, Node<T>, value);
+				auto it = std::upper_bound(sorted.begin(), sorted.end(), std::make_pair(p, INT32_MAX));
+				if (it != sorted.begin()) {
+					--it;
+					auto base = (size_t)((Block*)blocks[it->second])->buf.data();
+					if (p >= base && p < base + sizeof(Node<T>) * blockSize) {
+						auto n = operator[]((it->second << blockShift) + int32_t((p - base) / sizeof(Node<T>)));
+						if (n >= 0) {
+							w.pointer = &((Block*)blocks[n >> blockShift])->buf[n & blockMask].value;
+							return true;
+						}
+					}
+				}
+				w.Reset();
+				return false;
+			}
+
+			bool Fix(HolderType& h) const {
+				return Fix(h.weak);
+			}
+		};
+
+		// 整理碎片: 把 高下标的 在用节点 移到 低下标的 空位, 之后 len == Count(), 没有空位. freeBlocks: 释放 尾部 空块
+		// 节点 的 version 不变, 双链表 顺序 不变. 之后 所有 BlockLinkVI / BlockLinkWeak 都须用 返回的 Remap 修正( 未修正的 weak 可能 指向 已释放的块 )
+		// 只适用于 BlockLinkVIT / BlockLinkVINPT 这类 节点( 没有 其他 以下标 互相引用 的 字段 )
+		Remap Compact(bool freeBlocks = true) {
+			Remap rm;
+			auto oldLen = this->len;
+			rm.blocks.AddRange(this->blocks.buf, this->blocks.len);
+			rm.sorted.reserve(this->blocks.len);
+			for (int32_t i = 0; i < this->blocks.len; ++i) {
+				rm.sorted.emplace_back((size_t)((Block*)this->blocks[i])->buf.data(), i);
+			}
+			std::sort(rm.sorted.begin(), rm.sorted.end());
+			rm.idxs.Resize(oldLen);
+			for (int32_t i = 0; i < oldLen; ++i) {
+				rm.idxs[i] = RefNode(i).version < -2 ? i : -1;
+			}
+
+			for (int32_t lo = 0, hi = oldLen - 1;; ++lo, --hi) {
+				while (lo < hi && rm.idxs[lo] >= 0) ++lo;
+				while (hi > lo && rm.idxs[hi] < 0) --hi;
+				if (lo >= hi) break;
+				MoveNode(hi, lo);
+				rm.idxs[hi] = lo;
+			}
+
+			auto newLen = Count();
+			for (int32_t i = newLen; i < oldLen; ++i) {
+				RefNode(i).version = -2;
+			}
+			this->len = newLen;
+			this->freeHead = -1;
+			this->freeCount = 0;
+
+			if (freeBlocks) {
+				auto n = (newLen + blockMask) >> blockShift;
+				for (int32_t i = n; i < this->blocks.len; ++i) {
+					delete (MyAlignedStorage<Block>*)this->blocks[i];
+				}
+				this->blocks.Resize(n);
+				this->cap = n << blockShift;
+			}
+			return rm;
+		}
+
+		// 快照( 回滚 用 ): 在用的块 整块复制, 外加 len, free list, version 等. 可反复 复用( 不再分配内存 )
+		struct SnapshotData {
+			Listi32<uint8_t> buf;
+			int32_t numBlocks{}, len{}, freeHead{ -1 }, freeCount{}, version{ -2 }, head{ -1 }, tail{ -1 };
+		};
+
+		// 保存 当前状态 到 s. 只支持 可 memcpy 的 T
+		void Snapshot(SnapshotData& s) const requires std::is_trivially_copyable_v<T> {
+			s.numBlocks = (this->len + blockMask) >> blockShift;
+			s.buf.Resize(s.numBlocks * (int32_t)sizeof(Block));
+			for (int32_t i = 0; i < s.numBlocks; ++i) {
+				memcpy(s.buf.buf + i * sizeof(Block), this->blocks[i], sizeof(Block));
+			}
+			s.len = this->len;
+			s.freeHead = this->freeHead;
+			s.freeCount = this->freeCount;
+			s.version = this->version;
+			if constexpr (isDoubleLink) {
+				s.head = this->head;
+				s.tail = this->tail;
+			}
+		}
+
+		// 恢复到 s 的状态. 之后新建的 节点 失效( version 置 -2 ), 块 保留 不释放
+		// version 计数 也被恢复, 故 重新模拟 时 同位置 新建的 节点 会得到 相同的 version ( 旧的 weak 会 重新生效 )
+		void Restore(SnapshotData const& s) requires std::is_trivially_copyable_v<T> {
+			while (this->blocks.len < s.numBlocks) {
+				Reserve();
+			}
+			for (int32_t i = 0; i < s.numBlocks; ++i) {
+				memcpy(this->blocks[i], s.buf.buf + i * sizeof(Block), sizeof(Block));
+			}
+			for (int32_t i = s.len, e = std::min(this->len, s.numBlocks << blockShift); i < e; ++i) {
+				RefNode(i).version = -2;
+			}
+			for (int32_t i = s.numBlocks; i < this->blocks.len; ++i) {
+				auto& b = *(Block*)this->blocks[i];
+				if constexpr (enableFlags) {
+					b.flags = {};
+				}
+				for (int32_t j = 0, je = std::min((int32_t)blockSize, this->len - (i << blockShift)); j < je; ++j) {
+					b.buf[j].version = -2;
+				}
+			}
+			this->len = s.len;
+			this->freeHead = s.freeHead;
+			this->freeCount = s.freeCount;
+			this->version = s.version;
+			if constexpr (isDoubleLink) {
+				this->head = s.head;
+				this->tail = s.tail;
+			}
+		}
+
 		XX_INLINE void Reserve(int32_t newCap) {
-			if (newCap < this->cap) return;
-			auto n = ((uint32_t&)newCap + 63u) >> 6;
-			for (uint32_t i = 0; i < n; ++i) {
+			while (this->cap < newCap) {
 				Reserve();
 			}
 		}
@@ -406,6 +658,42 @@ namespace xx {
 			return { *this, EmplaceCore<appendToTail>(std::forward<Args>(args)...).value };
 		}
 
+		// 暂时 移出 链表( 不释放, 句柄 依旧有效 ), ForeachLink 不再访问. 之后 Attach 放回 或 Remove
+		// 注意: 不可在 ForeachLink 的 回调中 对 当前节点 调用
+		void Detach(Node<T>& o) requires isDoubleLink {
+			assert(o.version < -2);
+			if (o.index == this->head) {
+				this->head = o.next;
+			}
+			if (o.index == this->tail) {
+				this->tail = o.prev;
+			}
+			if (o.prev >= 0) {
+				RefNode(o.prev).next = o.next;
+			}
+			if (o.next >= 0) {
+				RefNode(o.next).prev = o.prev;
+			}
+			o.prev = o.next = -1;
+		}
+
+		// Detach 过的 节点 放回 链表
+		template<bool appendToTail = true>
+		void Attach(Node<T>& o) requires isDoubleLink {
+			assert(o.version < -2 && o.prev == -1 && o.next == -1 && this->head != o.index);
+			if (this->head == -1) {
+				this->head = this->tail = o.index;
+			} else if constexpr (appendToTail) {
+				o.prev = this->tail;
+				RefNode(this->tail).next = o.index;
+				this->tail = o.index;
+			} else {
+				o.next = this->head;
+				RefNode(this->head).prev = o.index;
+				this->head = o.index;
+			}
+		}
+
 	protected:
 
 		XX_INLINE int32_t GenVersion() {
@@ -417,12 +705,17 @@ namespace xx {
 
 		XX_INLINE Block& RefBlock(int32_t index) const {
 			assert(index >= 0 && index < this->cap);
-			return *(Block*)this->blocks[(uint32_t&)index >> 6];
+			return *(Block*)this->blocks[(uint32_t&)index >> blockShift];
+		}
+
+		// 只算地址, 不访问节点( 用于 prefetch )
+		XX_INLINE Node<T>* NodeAt(int32_t index) const {
+			return &RefBlock(index).buf[index & blockMask];
 		}
 
 		XX_INLINE Node<T>& RefNode(int32_t index) const {
 			auto& block = RefBlock(index);
-			auto& node = block.buf[index & 0b111111];
+			auto& node = block.buf[index & blockMask];
 			assert(node.index == index);
 			return node;
 		}
@@ -430,25 +723,27 @@ namespace xx {
 		template<bool value = true>
 		XX_INLINE void FlagSet(int32_t index) requires enableFlags {
 			auto& block = RefBlock(index);
-			auto bit = uint64_t(1) << (index & 0b111111);
+			auto idx = index & blockMask;
+			auto& flags = block.flags[idx >> 6];
+			auto bit = uint64_t(1) << (idx & 0b111111);
 			if constexpr (value) {
-				assert((block.flags & bit) == 0);
-				block.flags |= bit;
+				assert((flags & bit) == 0);
+				flags |= bit;
 			} else {
-				assert(((block.flags & bit) ^ bit) == 0);
-				block.flags &= ~bit;
+				assert(((flags & bit) ^ bit) == 0);
+				flags &= ~bit;
 			}
 		}
 
 		XX_INLINE void Reserve() {
 			auto len = this->blocks.len;
-			this->cap += 64;
+			this->cap += (int32_t)blockSize;
 			auto b = (Block*)this->blocks.Emplace((Block*)new MyAlignedStorage<Block>());
-			if constexpr (!isDoubleLink) {
-				b->flags = 0;
+			if constexpr (enableFlags) {
+				b->flags = {};
 			}
-			for (int32_t i = 0; i < 64; ++i) {
-				b->buf[i].index = 64 * len + i;
+			for (int32_t i = 0; i < (int32_t)blockSize; ++i) {
+				b->buf[i].index = (int32_t)blockSize * len + i;
 				if constexpr (HasMember_typeId<Node<T>>) {
 					b->buf[i].typeId = T::cTypeId;
 				}
@@ -483,11 +778,40 @@ namespace xx {
 			o.version = this->freeHead;
 			this->freeHead = index;
 			++this->freeCount;
-			if constexpr (!isDoubleLink) {
+			if constexpr (enableFlags) {
 				FlagSet<false>(index);
 			}
 		}
 
+		// 在用节点 from 移到 空位 to ( 值, version, 链接, flags )
+		void MoveNode(int32_t from, int32_t to) {
+			auto& a = RefNode(from);
+			auto& b = RefNode(to);
+			assert(a.version < -2 && b.version >= -2);
+			new (&b.value) T(std::move(a.value));
+			a.value.~T();
+			b.version = a.version;
+			a.version = -2;
+			if constexpr (isDoubleLink) {
+				b.prev = a.prev;
+				b.next = a.next;
+				if (b.prev >= 0) {
+					RefNode(b.prev).next = to;
+				} else if (this->head == from) {		// 否则 为 Detach 过的
+					this->head = to;
+				}
+				if (b.next >= 0) {
+					RefNode(b.next).prev = to;
+				} else if (this->tail == from) {
+					this->tail = to;
+				}
+			}
+			if constexpr (enableFlags) {
+				FlagSet<false>(from);
+				FlagSet(to);
+			}
+		}
+
 		template<bool appendToTail = true, typename...Args>
 		XX_INLINE Node<T>& EmplaceCore(Args&&... args) {
 			int32_t index;
@@ -502,7 +826,7 @@ namespace xx {
 				index = this->len;
 				this->len++;
 			}
-			if constexpr (!isDoubleLink) {
+			if constexpr (enableFlags) {
 				FlagSet(index);
 			}
 
@@ -542,9 +866,44 @@ namespace xx {
 	};
 
 
-	template<typename T, template<typename...> typename BlockNode>
-	BlockLinkHolder<T, BlockNode>:: ~BlockLinkHolder() {
+	template<typename T, template<typename...> typename BlockNode, size_t blockSize>
+	BlockLinkHolder<T, BlockNode, blockSize>:: ~BlockLinkHolder() {
 		if (!owner) return;
 		owner->Remove(weak);
 	}
+
+
+	// 环形 快照槽( 回滚 用 ): 按 帧号 保存 最近 numSlots 帧
+	// example:
+	//      xx::BlockLinkSnapshots<decltype(bl), 16> ss;
+	//      ss.Save(bl, frame);  ...  if (!ss.Load(bl, oldFrame)) { too old }
+	template<typename BL, size_t numSlots = 16>
+	struct BlockLinkSnapshots {
+		std::array<typename BL::SnapshotData, numSlots> slots;
+		std::array<int64_t, numSlots> frames;
+
+		BlockLinkSnapshots() {
+			frames.fill(-1);
+		}
+
+		void Save(BL const& bl, int64_t frame) {
+			assert(frame >= 0);
+			auto i = size_t(frame) % numSlots;
+			bl.Snapshot(slots[i]);
+			frames[i] = frame;
+		}
+
+		// 返回 false: 该帧 不在( 太旧 或 未保存 )
+		bool Load(BL& bl, int64_t frame) const {
+			if (frame < 0) return false;
+			auto i = size_t(frame) % numSlots;
+			if (frames[i] != frame) return false;
+			bl.Restore(slots[i]);
+			return true;
+		}
+
+		bool Has(int64_t frame) const {
+			return frame >= 0 && frames[size_t(frame) % numSlots] == frame;
+		}
+	};
 }
@@ -0,0 +1,176 @@
+﻿#pragma once
+#include "xx_blocklink.h"
+
+namespace xx {
+
+	// 冷热分离( hot / cold ) 的 BlockLink: 每帧 更新 要用的 少量字段 H( 位置, 速度, 状态 ... ) 存于 平行的 热块, 其余 T 存于 内部 BlockLink 的 节点
+	// 下标 / version / free list / BlockLinkWeak 都沿用 内部 BlockLink ( 句柄 指向 T ). ForeachHot 只读 flags + H, 不碰 T 所在的 缓存行
+	// 内部 BlockLink 总是开启 flags ( 双链表 也可 按 flags 遍历 )
+	template<typename T, typename H, template<typename...> typename Node = BlockLinkVINPT, size_t blockSize = 64>
+	struct BlockLinkHC {
+		static constexpr bool isDoubleLink = BlockLinkIsDoubleLink_v<Node<T>>;
+		using BL = BlockLink<T, Node, isDoubleLink, true, blockSize>;
+		using NodeType = Node<T>;
+		using WeakType = BlockLinkWeak<T, Node>;
+
+		BL bl;					// 冷数据
+		Listi32<H*> hots;		// 热块, 与 bl.blocks 一一对应
+
+		BlockLinkHC() = default;
+		BlockLinkHC(BlockLinkHC const&) = delete;
+		BlockLinkHC& operator=(BlockLinkHC const&) = delete;
+		BlockLinkHC(BlockLinkHC&& o) noexcept {
+			std::swap(bl, o.bl);
+			std::swap(hots, o.hots);
+		}
+		BlockLinkHC& operator=(BlockLinkHC&& o) noexcept {
+			std::swap(bl, o.bl);
+			std::swap(hots, o.hots);
+			return *this;
+		}
+		~BlockLinkHC() {
+			Clear<true, true>();
+		}
+
+		template<bool freeBuf = false, bool resetVersion = false>
+		void Clear() {
+			if constexpr (!std::is_trivially_destructible_v<H>) {
+				if (bl.len > 0) {
+					bl.ForeachFlagsIndex([this](auto&, int32_t index) {
+						std::destroy_at(&RefHot(index));
+						return true;
+					});
+				}
+			}
+			bl.template Clear<freeBuf, resetVersion>();
+			if constexpr (freeBuf) {
+				for (auto& o : hots) {
+					delete[](MyAlignedStorage<H>*)o;
+				}
+				hots.Clear(true);
+			}
+		}
+
+		XX_INLINE int32_t Count() const {
+			return bl.Count();
+		}
+
+		XX_INLINE bool Empty() const {
+			return bl.Empty();
+		}
+
+		XX_INLINE H& RefHot(int32_t index) const {
+			return hots[index >> BL::blockShift][index & BL::blockMask];
+		}
+
+		XX_INLINE H& RefHot(T const& v) const {
+			return RefHot(container_of(&v, NodeType, value)->index);
+		}
+
+		XX_INLINE H* TryGetHot(WeakType const& w) const {
+			return w ? &RefHot(*w.pointer) : nullptr;
+		}
+
+		// h: 热数据, args: T 的构造参数
+		template<bool appendToTail = true, typename HA, typename...Args>
+		NodeType& EmplaceNode(HA&& h, Args&&... args) {
+			auto& o = bl.template EmplaceNode<appendToTail>(std::forward<Args>(args)...);
+			while (hots.len < bl.blocks.len) {
+				hots.Emplace((H*)new MyAlignedStorage<H>[blockSize]);
+			}
+			std::construct_at(&RefHot(o.index), std::forward<HA>(h));
+			return o;
+		}
+
+		template<bool appendToTail = true, typename HA, typename...Args>
+		T& Emplace(HA&& h, Args&&... args) {
+			return EmplaceNode<appendToTail>(std::forward<HA>(h), std::forward<Args>(args)...).value;
+		}
+
+		template<bool appendToTail = true, typename HA, typename...Args>
+		WeakType WeakEmplace(HA&& h, Args&&... args) {
+			return { EmplaceNode<appendToTail>(std::forward<HA>(h), std::forward<Args>(args)...).value };
+		}
+
+		void Remove(T const& v) {
+			std::destroy_at(&RefHot(v));
+			bl.Remove(v);
+		}
+
+		bool Remove(BlockLinkVI const& vi) {
+			auto o = bl.TryGet(vi);
+			if (!o) return false;
+			Remove(o->value);
+			return true;
+		}
+
+		void Remove(WeakType const& w) {
+			if (w) {
+				Remove(*w.pointer);
+			}
+		}
+
+		// 只遍历 热数据
+		// .ForeachHot( [](H& h)->void {    } );
+		// .ForeachHot( [](H& h)->xx::ForeachResult {    } );
+		template<typename F, typename R = std::invoke_result_t<F, H&>>
+		void ForeachHot(F&& func) {
+			if (bl.len <= 0) return;
+			bl.ForeachFlagsIndex([&](typename BL::Block& block, int32_t index) {
+				auto& h = RefHot(index);
+				if constexpr (std::is_void_v<R>) {
+					func(h);
+				} else {
+					auto r = func(h);
+					switch (r) {
+					case ForeachResult::Continue: break;
+					case ForeachResult::RemoveAndContinue:
+						Remove(block.buf[index & BL::blockMask].value);
+						break;
+					case ForeachResult::Break: return false;
+					case ForeachResult::RemoveAndBreak:
+						Remove(block.buf[index & BL::blockMask].value);
+						return false;
+					}
+				}
+				return true;
+			});
+		}
+
+		// 冷热 一起 遍历
+		// .ForeachFlags( [](T& o, H& h)->void {    } );
+		// .ForeachFlags( [](T& o, H& h)->xx::ForeachResult {    } );
+		template<typename F, typename R = std::invoke_result_t<F, T&, H&>>
+		void ForeachFlags(F&& func) {
+			bl.ForeachFlags([&](T& o) {
+				return Call<R>(func, o);
+			});
+		}
+
+		// .ForeachLink( [](T& o, H& h)->void {    } );
+		// .ForeachLink( [](T& o, H& h)->xx::ForeachResult {    } );
+		template<bool fromHead = true, typename F, typename R = std::invoke_result_t<F, T&, H&>>
+		void ForeachLink(F&& func, int32_t beginIdx = -1) requires isDoubleLink {
+			bl.template ForeachLink<fromHead>([&](T& o) {
+				return Call<R>(func, o);
+			}, beginIdx);
+		}
+
+	protected:
+		// 调用 func(o, h). 要删除 时 先析构 h, 再由 bl 删除 o
+		template<typename R, typename F>
+		XX_INLINE auto Call(F& func, T& o) {
+			auto& h = RefHot(o);
+			if constexpr (std::is_void_v<R>) {
+				func(o, h);
+			} else {
+				auto r = func(o, h);
+				if (r == ForeachResult::RemoveAndContinue || r == ForeachResult::RemoveAndBreak) {
+					std::destroy_at(&h);
+				}
+				return r;
+			}
+		}
+	};
+
+}
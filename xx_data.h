@@ -1,5 +1,5 @@
 ﻿#pragma once
-#include "xx_typetraits.h"
+#include "xx_data_pool.h"
 
 namespace xx {
 
@@ -90,6 +90,23 @@ namespace xx {
     template<>
     struct IsPod<Span, void> : std::true_type {};
 
+    // Data / DataShared 的 buf 分配与释放( 定义 XX_DATA_USE_POOL 则走 DataPool )
+    XX_INLINE uint8_t* DataAlloc(size_t siz) {
+#ifdef XX_DATA_USE_POOL
+        return DataPool::Alloc(siz);
+#else
+        return new uint8_t[siz];
+#endif
+    }
+
+    XX_INLINE void DataFree(uint8_t* p) {
+#ifdef XX_DATA_USE_POOL
+        DataPool::Free(p);
+#else
+        delete[](p);
+#endif
+    }
+
     // Data 序列化 / 反序列化 基础适配模板
     template<typename T, typename ENABLED>
     struct DataFuncs;
@@ -316,6 +333,62 @@ namespace xx {
             return __LINE__;
         }
 
+        // 读 变长整数 数组( 结果同逐个 ReadVarInteger ). 4 字节整数 遇到连续单字节值时 走 simd 批量解码. 返回非 0 则读取失败
+        template<typename T, typename = std::enable_if_t<std::is_integral_v<T> && sizeof(T) >= 2>>
+        [[maybe_unused]] [[nodiscard]] XX_INLINE int ReadVarIntegerArray(T* tar, size_t siz) {
+            assert(tar || !siz);
+            size_t i = 0;
+#ifdef XX_SIMD_SSE4
+            if constexpr (sizeof(T) == 4) {
+                while (i + 16 <= siz && offset + 16 <= len) {
+                    auto v = _mm_loadu_si128((__m128i const*)(buf + offset));
+                    auto mask = (uint32_t)_mm_movemask_epi8(v);
+                    if (mask) {
+                        // 前 n 个字节为单字节值, 第 n + 1 个值 为多字节
+                        auto n = (size_t)std::countr_zero(mask);
+                        for (size_t e = i + n; i < e; ++i) {
+                            uint32_t u = buf[offset++];
+                            if constexpr (std::is_signed_v<T>) tar[i] = ZigZagDecode(u);
+                            else tar[i] = u;
+                        }
+                        if (int r = ReadVarInteger(tar[i])) return r;
+                        ++i;
+                        continue;
+                    }
+                    // 16 个单字节值 展开为 int32
+                    auto p = (__m128i*)(tar + i);
+#ifdef XX_SIMD_AVX2
+                    auto w0 = _mm256_cvtepu8_epi32(v);
+                    auto w1 = _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8));
+                    if constexpr (std::is_signed_v<T>) {
+                        auto one = _mm256_set1_epi32(1), zero = _mm256_setzero_si256();
+                        w0 = _mm256_xor_si256(_mm256_srli_epi32(w0, 1), _mm256_sub_epi32(zero, _mm256_and_si256(w0, one)));
+                        w1 = _mm256_xor_si256(_mm256_srli_epi32(w1, 1), _mm256_sub_epi32(zero, _mm256_and_si256(w1, one)));
+                    }
+                    _mm256_storeu_si256((__m256i*)p, w0);
+                    _mm256_storeu_si256((__m256i*)p + 1, w1);
+#else
+                    for (int k = 0; k < 4; ++k) {
+                        auto w = _mm_cvtepu8_epi32(v);
+                        if constexpr (std::is_signed_v<T>) {
+                            auto one = _mm_set1_epi32(1), zero = _mm_setzero_si128();
+                            w = _mm_xor_si128(_mm_srli_epi32(w, 1), _mm_sub_epi32(zero, _mm_and_si128(w, one)));
+                        }
+                        _mm_storeu_si128(p + k, w);
+                        v = _mm_srli_si128(v, 4);
+                    }
+#endif
+                    offset += 16;
+                    i += 16;
+                }
+            }
+#endif
+            for (; i < siz; ++i) {
+                if (int r = ReadVarInteger(tar[i])) return r;
+            }
+            return 0;
+        }
+
 
         // 从 buf[offset] 处填充一个指定长度的 string_view. 返回非 0 则读取失败
         [[maybe_unused]] [[nodiscard]] XX_INLINE int ReadSV(std::string_view& sv, size_t siz) {
@@ -386,7 +459,7 @@ namespace xx {
                 : cap(cap) {
             assert(cap);
             auto siz = Round2n(bufHeaderReserveLen + cap);
-            buf = (new uint8_t[siz]) + bufHeaderReserveLen;
+            buf = DataAlloc(siz) + bufHeaderReserveLen;
             this->cap = siz - bufHeaderReserveLen;
         }
 
@@ -461,14 +534,14 @@ namespace xx {
                 siz = bufHeaderReserveLen + newCap;
             }
 
-            auto newBuf = new uint8_t[siz] + bufHeaderReserveLen;
+            auto newBuf = DataAlloc(siz) + bufHeaderReserveLen;
             if (len) {
                 memcpy(newBuf, buf, len);
             }
 
             // 这里判断 cap 不判断 buf, 是因为 gcc 优化会导致 if 失效, 无论如何都会执行 delete
             if (cap) {
-                delete[](buf - bufHeaderReserveLen);
+                DataFree(buf - bufHeaderReserveLen);
             }
             buf = newBuf;
             cap = siz - bufHeaderReserveLen;
@@ -479,9 +552,9 @@ namespace xx {
             if (!len) {
                 Clear(true);
             } else if (cap > len * 2) {
-                auto newBuf = new uint8_t[bufHeaderReserveLen + len] + bufHeaderReserveLen;
+                auto newBuf = DataAlloc(bufHeaderReserveLen + len) + bufHeaderReserveLen;
                 memcpy(newBuf, buf, len);
-                delete[](buf - bufHeaderReserveLen);
+                DataFree(buf - bufHeaderReserveLen);
                 buf = newBuf;
                 cap = len;
             }
@@ -491,7 +564,7 @@ namespace xx {
         Data_rw ShrinkCopy() {
             Data_rw rtv;
             if (len) {
-                rtv.buf = new uint8_t[bufHeaderReserveLen + len] + bufHeaderReserveLen;
+                rtv.buf = DataAlloc(bufHeaderReserveLen + len) + bufHeaderReserveLen;
                 memcpy(rtv.buf, buf, len);
                 rtv.cap = rtv.len = len;
             }
@@ -682,6 +755,78 @@ namespace xx {
             buf[len++] = uint8_t(u);
         }
 
+        // 追加写入整数数组( 结果同逐个 WriteVarInteger ). 4 字节整数 走 simd 批量编码 ( 每组 全单字节 / 全双字节 时直接打包 )
+        template<bool needReserve = true, typename T, typename = std::enable_if_t<std::is_integral_v<T> && sizeof(T) >= 2>>
+        [[maybe_unused]] XX_INLINE void WriteVarIntegerArray(T const* ptr, size_t siz) {
+            assert(ptr || !siz);
+            if constexpr (needReserve) {
+                if (len + siz * (sizeof(T) + 2) > cap) {
+                    Reserve<false>(len + siz * (sizeof(T) + 2));
+                }
+            }
+            size_t i = 0;
+#ifdef XX_SIMD_AVX2
+            if constexpr (sizeof(T) == 4) {
+                auto s1 = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+                    , 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+                auto s2 = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1
+                    , 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+                for (; i + 8 <= siz; i += 8) {
+                    auto v = _mm256_loadu_si256((__m256i const*)(ptr + i));
+                    if constexpr (std::is_signed_v<T>) {
+                        v = _mm256_xor_si256(_mm256_slli_epi32(v, 1), _mm256_srai_epi32(v, 31));
+                    }
+                    if (_mm256_testz_si256(v, _mm256_set1_epi32(~0x7F))) {
+                        auto b = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, s1), _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+                        _mm_storel_epi64((__m128i*)(buf + len), _mm256_castsi256_si128(b));
+                        len += 8;
+                    } else if (_mm256_testz_si256(v, _mm256_set1_epi32(~0x3FFF))
+                        && !_mm256_movemask_epi8(_mm256_cmpgt_epi32(_mm256_set1_epi32(0x80), v))) {
+                        auto w = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(v, _mm256_set1_epi32(0x7F)), _mm256_set1_epi32(0x80))
+                            , _mm256_slli_epi32(_mm256_srli_epi32(v, 7), 8));
+                        auto b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(w, s2), 0b1000);
+                        _mm_storeu_si128((__m128i*)(buf + len), _mm256_castsi256_si128(b));
+                        len += 16;
+                    } else {
+                        for (size_t e = i + 8, j = i; j < e; ++j) {
+                            WriteVarInteger<false>(ptr[j]);
+                        }
+                    }
+                }
+            }
+#endif
+#ifdef XX_SIMD_SSE4
+            if constexpr (sizeof(T) == 4) {
+                auto s1 = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+                auto s2 = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+                for (; i + 4 <= siz; i += 4) {
+                    auto v = _mm_loadu_si128((__m128i const*)(ptr + i));
+                    if constexpr (std::is_signed_v<T>) {
+                        v = _mm_xor_si128(_mm_slli_epi32(v, 1), _mm_srai_epi32(v, 31));
+                    }
+                    if (_mm_testz_si128(v, _mm_set1_epi32(~0x7F))) {
+                        auto b = _mm_cvtsi128_si32(_mm_shuffle_epi8(v, s1));
+                        memcpy(buf + len, &b, 4);
+                        len += 4;
+                    } else if (_mm_testz_si128(v, _mm_set1_epi32(~0x3FFF))
+                        && !_mm_movemask_epi8(_mm_cmpgt_epi32(_mm_set1_epi32(0x80), v))) {
+                        auto w = _mm_or_si128(_mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0x7F)), _mm_set1_epi32(0x80))
+                            , _mm_slli_epi32(_mm_srli_epi32(v, 7), 8));
+                        _mm_storel_epi64((__m128i*)(buf + len), _mm_shuffle_epi8(w, s2));
+                        len += 8;
+                    } else {
+                        for (size_t e = i + 4, j = i; j < e; ++j) {
+                            WriteVarInteger<false>(ptr[j]);
+                        }
+                    }
+                }
+            }
+#endif
+            for (; i < siz; ++i) {
+                WriteVarInteger<false>(ptr[i]);
+            }
+        }
+
 
         // 跳过指定长度字节数不写。返回起始 len
         template<bool needReserve = true>
@@ -699,7 +844,8 @@ namespace xx {
         // 跳过指定长度字节数不写。返回起始 指针
         template<bool needReserve = true>
         [[maybe_unused]] XX_INLINE uint8_t* WriteSpace(size_t siz) {
-            return buf + WriteJump<needReserve>(siz);
+            auto idx = WriteJump<needReserve>(siz);     // WriteJump may change buf
+            return buf + idx;
         }
 
         // 支持同时写入多个值
@@ -722,8 +868,7 @@ namespace xx {
         // len 清 0, 可彻底释放 buf
         XX_INLINE void Clear(bool freeBuf = false) {
             if (freeBuf && cap) {
-                //delete[](buf - bufHeaderReserveLen);
-                delete[](buf - bufHeaderReserveLen);
+                DataFree(buf - bufHeaderReserveLen);
                 buf = nullptr;
                 cap = 0;
             }
@@ -1009,15 +1154,7 @@ namespace xx {
             if constexpr (sizeof(U) == 1 || std::is_floating_point_v<U>) {
                 d.WriteFixedArray<needReserve>(in.data(), in.size());
             } else if constexpr (std::is_integral_v<U>) {
-                if constexpr (needReserve) {
-                    auto cap = in.size() * (sizeof(U) + 2);
-                    if (d.cap < cap) {
-                        d.Reserve<false>(cap);
-                    }
-                }
-                for (auto&& o : in) {
-                    d.WriteVarInteger<false>(o);
-                }
+                d.WriteVarIntegerArray<needReserve>(in.data(), in.size());
             } else {
                 for (auto&& o : in) {
                     d.Write<needReserve>(o);
@@ -1037,6 +1174,8 @@ namespace xx {
             auto buf = out.data();
             if constexpr (sizeof(U) == 1 || std::is_floating_point_v<U>) {
                 if (int r = d.ReadFixedArray(buf, siz)) return r;
+            } else if constexpr (std::is_integral_v<U>) {
+                if (int r = d.ReadVarIntegerArray(buf, siz)) return r;
             } else {
                 for (size_t i = 0; i < siz; ++i) {
                     if (int r = d.Read(buf[i])) return r;
@@ -1187,6 +1326,100 @@ namespace xx {
         }
     };
 
+    // 编码格式 即 内存布局( little endian ) 的类型: std::vector<T> / List<T> 序列化时 为 长度 + 原始内存. 可特化
+    template<typename T, typename ENABLED = void>
+    struct DataRawLayout : std::integral_constant<bool, (std::is_arithmetic_v<T> && sizeof(T) == 1) || std::is_floating_point_v<T>> {};
+    template<typename T> constexpr bool DataRawLayout_v = DataRawLayout<std::remove_cvref_t<T>>::value;
+
+    // 数组 只读视图( 零拷贝 ): Read 时直接指向 Data_r 的缓冲区( 需自己保证 缓冲区 生命周期 ), 编码格式同 std::vector<T> / List<T>
+    // 如果 缓冲区位置 未按 alignof(T) 对齐( 或 big endian ), 则复制到 owned 再指向它
+    // example: xx::ArrayView<float> vs; d.Read(vs); for (auto& v : vs) { ... }
+    template<typename T>
+    struct ArrayView {
+        static_assert(DataRawLayout_v<T>);
+        using ChildType = T;
+        T const* buf{};
+        size_t len{};
+        std::unique_ptr<T[]> owned;
+
+        ArrayView() = default;
+        ArrayView(ArrayView const&) = delete;
+        ArrayView& operator=(ArrayView const&) = delete;
+        ArrayView(ArrayView&&) noexcept = default;
+        ArrayView& operator=(ArrayView&&) noexcept = default;
+
+        // 引用一段数据
+        ArrayView(T const* buf_, size_t len_)
+            : buf(buf_), len(len_) {
+        }
+
+        XX_INLINE T const& operator[](size_t idx) const {
+            assert(idx < len);
+            return buf[idx];
+        }
+
+        XX_INLINE size_t Len() const {
+            return len;
+        }
+
+        XX_INLINE bool Empty() const {
+            return !len;
+        }
+
+        // 是否为 复制 而非 直接引用
+        XX_INLINE bool IsOwned() const {
+            return (bool)owned;
+        }
+
+        XX_INLINE T const* begin() const {
+            return buf;
+        }
+
+        XX_INLINE T const* end() const {
+            return buf + len;
+        }
+    };
+    template<typename T> constexpr bool IsArrayView_v = TemplateIsSame_v<std::remove_cvref_t<T>, ArrayView<AnyType>>;
+
+    template<typename T>
+    struct DataFuncs<T, std::enable_if_t< IsArrayView_v<T> >> {
+        using U = typename T::ChildType;
+        template<bool needReserve = true>
+        static inline void Write(Data& d, T const& in) {
+            d.WriteVarInteger<needReserve>(in.len);
+            if (!in.len) return;
+            if constexpr (std::is_arithmetic_v<U>) {
+                d.WriteFixedArray<needReserve>(in.buf, in.len);
+            } else {
+                d.WriteBuf<needReserve>(in.buf, in.len * sizeof(U));
+            }
+        }
+        static inline int Read(Data_r& d, T& out) {
+            size_t siz = 0;
+            if (int r = d.ReadVarInteger(siz)) return r;
+            if (siz > (d.len - d.offset) / sizeof(U)) return __LINE__;
+            out.owned.reset();
+            out.len = siz;
+            if (!siz) {
+                out.buf = nullptr;
+                return 0;
+            }
+            auto p = d.buf + d.offset;
+            if (std::endian::native == std::endian::little && (size_t)p % alignof(U) == 0) {
+                out.buf = (U const*)p;
+                d.offset += siz * sizeof(U);
+                return 0;
+            }
+            out.owned.reset(new U[siz]);
+            out.buf = out.owned.get();
+            if constexpr (std::is_arithmetic_v<U>) {
+                return d.ReadFixedArray(out.owned.get(), siz);
+            } else {
+                return d.ReadBuf(out.owned.get(), siz * sizeof(U));
+            }
+        }
+    };
+
     // 适配 存有 uint16 范围值的 float
     // example: d.Read( (xx::RWFloatUInt16&)x )
     struct RWFloatUInt16 {
@@ -1227,4 +1460,90 @@ namespace xx {
         }
     };
 
+    /**********************************************************************************************************************/
+    // 字段列表 序列化: 在类内使用 XX_DATA_FIELDS(a, b, c) 生成 DataFields(), 自动适配 DataFuncs ( 按字段顺序 Write / Read )
+    // 如果所有字段的 编码长度 都有上限( 数值, enum, 定长数组, 嵌套的 XX_DATA_FIELDS 类 ... ), 则 DataMaxSize_v<T> 为其总上限,
+    // Write 时只 Reserve 一次, 之后所有字段 走 needReserve = false 路径
+    // example: struct Foo { int a; float b; XY c; XX_DATA_FIELDS(a, b, c) };
+
+#define XX_DATA_FIELDS(...) \
+    XX_INLINE auto DataFields() const { return std::tie(__VA_ARGS__); } \
+    XX_INLINE auto DataFields() { return std::tie(__VA_ARGS__); }
+
+    template<typename T> concept Has_DataFields = requires(T const& t) { t.DataFields(); };
+
+    // 类型 编码长度上限. 0 表示 不定长( 容器, 字符串 等 ). 自定义定长类型 可特化
+    template<typename T, typename ENABLED = void>
+    struct DataMaxSize : std::integral_constant<size_t, 0> {};
+    template<typename T> constexpr size_t DataMaxSize_v = DataMaxSize<std::remove_cvref_t<T>>::value;
+
+    // 求和. 有任意一个 不定长 则返回 0
+    template<typename ...TS>
+    constexpr size_t DataMaxSizeSum() {
+        if constexpr (((DataMaxSize_v<TS> == 0) || ...)) return 0;
+        else return (DataMaxSize_v<TS> + ... + 0);
+    }
+
+    // 1 字节数值, float / double ( 定长 )
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t< (std::is_arithmetic_v<T> && sizeof(T) == 1) || std::is_floating_point_v<T> >>
+        : std::integral_constant<size_t, sizeof(T)> {};
+
+    // 2+ 字节整数( 变长. 与 WriteVarInteger 的预留长度 一致 )
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<std::is_integral_v<T> && sizeof(T) >= 2>>
+        : std::integral_constant<size_t, sizeof(T) + 2> {};
+
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<std::is_enum_v<T>>>
+        : std::integral_constant<size_t, DataMaxSize_v<std::underlying_type_t<T>>> {};
+
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<IsStdArray_v<T>>>
+        : std::integral_constant<size_t, DataMaxSize_v<typename T::value_type> * std::tuple_size_v<T>> {};
+
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<IsStdOptional_v<T>>>
+        : std::integral_constant<size_t, DataMaxSize_v<typename T::value_type> ? 1 + DataMaxSize_v<typename T::value_type> : 0> {};
+
+    template<typename K, typename V>
+    struct DataMaxSize<std::pair<K, V>, void>
+        : std::integral_constant<size_t, DataMaxSizeSum<K, V>()> {};
+
+    template<typename ...TS>
+    struct DataMaxSize<std::tuple<TS...>, void>
+        : std::integral_constant<size_t, DataMaxSizeSum<TS...>()> {};
+
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<Has_DataFields<T>>>
+        : std::integral_constant<size_t, DataMaxSize_v<decltype(std::declval<T const&>().DataFields())>> {};
+
+    // 适配 XX_DATA_FIELDS
+    template<typename T>
+    struct DataFuncs<T, std::enable_if_t<Has_DataFields<T>>> {
+        static constexpr size_t maxSize = DataMaxSize_v<T>;
+        template<bool needReserve = true>
+        static inline void Write(Data& d, T const& in) {
+            if constexpr (maxSize > 0) {
+                if constexpr (needReserve) {
+                    if (d.len + maxSize > d.cap) {
+                        d.Reserve<false>(d.len + maxSize);
+                    }
+                }
+                std::apply([&](auto const&... fs) {
+                    d.Write<false>(fs...);
+                    }, in.DataFields());
+            } else {
+                std::apply([&](auto const&... fs) {
+                    d.Write<needReserve>(fs...);
+                    }, in.DataFields());
+            }
+        }
+        static inline int Read(Data_r& d, T& out) {
+            return std::apply([&](auto&... fs) {
+                return d.Read(fs...);
+                }, out.DataFields());
+        }
+    };
+
 }
@@ -0,0 +1,127 @@
+﻿#pragma once
+#include "xx_list.h"
+
+namespace xx {
+
+	// 分段( rope )写入容器: 数据追加到一串 定长块, 增长时 不会复制 已写满的块. 写入接口同 Data::Write ( 走 DataFuncs )
+	// 只有 单次写入 超出当前块剩余空间时, 才会扩容复制 当前块( 复制量 <= 块长 + 该值长度 ). 先 Reserve 再 Write<false> 则完全不复制
+	// 可通过 ForeachSpan / GetSpans 得到 iovec 风格的 块列表 直接交给 socket / file 写, 确实需要连续内存时 才 Flatten
+	template<size_t blockSize = 4096>
+	struct DataChain {
+		static constexpr size_t hLen = Data::GetBufHeaderReserveLen();
+		static constexpr size_t blockCap = blockSize - hLen;
+		static_assert(blockSize >= 256 && std::has_single_bit(blockSize));
+
+		List<Data, int> blocks;		// 已写满的块
+		Data cur;					// 当前块
+		size_t blocksLen{};			// blocks 数据总长( 不含 cur )
+
+		DataChain() = default;
+		DataChain(DataChain const&) = delete;
+		DataChain& operator=(DataChain const&) = delete;
+		DataChain(DataChain&& o) noexcept
+			: blocks(std::move(o.blocks))
+			, cur(std::move(o.cur))
+			, blocksLen(o.blocksLen) {
+			o.blocksLen = 0;
+		}
+		DataChain& operator=(DataChain&& o) noexcept {
+			std::swap(blocks, o.blocks);
+			std::swap(cur, o.cur);
+			std::swap(blocksLen, o.blocksLen);
+			return *this;
+		}
+
+		// 数据总长
+		XX_INLINE size_t GetLen() const {
+			return blocksLen + cur.len;
+		}
+
+		XX_INLINE operator bool() const {
+			return GetLen() != 0;
+		}
+
+		// 确保 当前块 剩余空间 >= siz ( 不够就 封存当前块 并开新块 ), 之后可用 Write<false> 连续写入
+		void Reserve(size_t siz) {
+			if (cur.len + siz <= cur.cap) return;
+			Commit();
+			cur.Reserve<false, false>(siz > blockCap ? siz : blockCap);
+		}
+
+		// 支持同时写入多个值
+		template<bool needReserve = true, typename ...TS>
+		void Write(TS const& ...vs) {
+			if constexpr (needReserve) {
+				if (!cur.cap) {
+					cur.Reserve<false, false>(blockCap);
+				}
+			}
+			cur.Write<needReserve>(vs...);
+			if (cur.len + blockCap / 8 > cur.cap) {
+				Commit();
+			}
+		}
+
+		// 追加写入一段 buf( 不记录数据长度 ). 按块切分 填充, 不会扩容复制
+		void WriteBuf(void const* ptr, size_t siz) {
+			auto p = (uint8_t const*)ptr;
+			while (siz) {
+				if (cur.len == cur.cap) {
+					Commit();
+					cur.Reserve<false, false>(blockCap);
+				}
+				auto n = std::min(siz, cur.cap - cur.len);
+				cur.WriteBuf<false>(p, n);
+				p += n;
+				siz -= n;
+			}
+		}
+
+		// 封存当前块( 如果非空 )
+		void Commit() {
+			if (!cur.len) return;
+			blocksLen += cur.len;
+			blocks.Emplace(std::move(cur));
+		}
+
+		// 遍历所有非空块. f(Span)
+		template<typename F>
+		void ForeachSpan(F&& f) const {
+			for (int i = 0, e = blocks.len; i < e; ++i) {
+				f(Span(blocks[i].buf, blocks[i].len));
+			}
+			if (cur.len) {
+				f(Span(cur.buf, cur.len));
+			}
+		}
+
+		// 填充 iovec 风格 块列表( 先清空 out )
+		void GetSpans(List<Span, int>& out) const {
+			out.Clear();
+			out.Reserve(blocks.len + 1);
+			ForeachSpan([&](Span const& s) {
+				out.Emplace(s);
+			});
+		}
+
+		// 合并为一份连续内存的 Data ( 一次复制, 可继续 move 给 DataShared )
+		Data Flatten() const {
+			Data d;
+			if (auto siz = GetLen()) {
+				d.Reserve<false, false>(siz);
+				ForeachSpan([&](Span const& s) {
+					d.WriteBuf<false>(s.buf, s.len);
+				});
+			}
+			return d;
+		}
+
+		// 清除所有数据. 默认保留 当前块 内存 方便复用
+		void Clear(bool freeBuf = false) {
+			blocks.Clear(freeBuf);
+			cur.Clear(freeBuf);
+			blocksLen = 0;
+		}
+	};
+
+}
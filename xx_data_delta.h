@@ -0,0 +1,109 @@
+﻿#pragma once
+#include "xx_data.h"
+
+namespace xx {
+
+    // 差异( delta )编码: 以 base( 上一次的 完整快照 )为基准, 对 cur 做 字节 XOR + 游程 编码. 适合 每帧 大部分内容 不变的 快照
+    // 格式: 变长 cur 长度, { 变长 相同字节数, 变长 差异字节数, 差异字节 ^ base }..., 以 差异字节数 == 0 结尾. 超出 base 长度的部分 视 base 为 0
+    // 注意: 变长整数 长度变化 会导致 其后的内容 错位, 此时 差异会变大( 但结果依旧正确 )
+    // example:
+    //      auto full = si.MakeDataShared(scene);
+    //      xx::Data d; xx::WriteDelta(d, xx::Data_r(baseline), xx::Data_r(full));  ...  baseline = full;
+    //      ( 接收方 ) xx::Data full; if (int r = xx::ReadDelta(dr, baseline, full)) ...  baseline = full;
+
+    namespace Delta {
+        static constexpr size_t minSameLen = 4;     // 相同字节 连续 达到该长度 才切分
+
+        XX_INLINE uint8_t At(Span const& s, size_t idx) {
+            return idx < s.len ? s.buf[idx] : 0;
+        }
+
+        // 从 base 复制 [from, to) 到 tar( 超出 base 长度的部分 填 0 )
+        XX_INLINE void CopyBase(uint8_t* tar, Span const& base, size_t from, size_t to) {
+            if (from >= to) return;
+            if (from < base.len) {
+                auto e = std::min(to, base.len);
+                memcpy(tar + from, base.buf + from, e - from);
+                from = e;
+            }
+            if (from < to) {
+                memset(tar + from, 0, to - from);
+            }
+        }
+    }
+
+    // 生成 cur 相对于 base 的 差异数据, 追加写入 d
+    inline void WriteDelta(Data& d, Span const& base, Span const& cur) {
+        auto n = cur.len;
+        auto m = std::min(base.len, n);
+        d.WriteVarInteger(n);
+        size_t i = 0;
+        while (i < n) {
+            // 相同段( 先按 8 字节 比较 )
+            auto z = i;
+            while (z + 8 <= m && memcmp(cur.buf + z, base.buf + z, 8) == 0) {
+                z += 8;
+            }
+            while (z < n && cur.buf[z] == Delta::At(base, z)) {
+                ++z;
+            }
+            if (z == n) break;
+
+            // 差异段: 直到出现 minSameLen 个连续相同字节
+            auto l = z;
+            size_t same{};
+            for (; l < n; ++l) {
+                if (cur.buf[l] == Delta::At(base, l)) {
+                    if (++same == Delta::minSameLen) {
+                        l -= Delta::minSameLen - 1;
+                        break;
+                    }
+                } else {
+                    same = 0;
+                }
+            }
+
+            auto siz = l - z;
+            d.WriteVarInteger(z - i);
+            d.WriteVarInteger(siz);
+            auto p = d.WriteSpace(siz);
+            for (size_t k = 0; k < siz; ++k) {
+                p[k] = cur.buf[z + k] ^ Delta::At(base, z + k);
+            }
+            i = l;
+        }
+        d.WriteFixed((uint8_t)0);     // end: 相同字节数 0
+        d.WriteFixed((uint8_t)0);     // end: 差异字节数 0
+    }
+
+    // 从 dr 读 差异数据, 结合 base 还原出 完整数据 到 out ( 先 Clear ). 返回非 0 则读取失败
+    // maxLen: 还原后 最大长度( 数据 不可信 时 防 伪造长度 导致 超大分配 ). 不能 按 dr 长度 推算: base 之外 的 0 不占 差异字节
+    inline int ReadDelta(Data_r& dr, Span const& base, Data& out, size_t maxLen = 64 * 1024 * 1024) {
+        size_t n;
+        if (int r = dr.ReadVarInteger(n)) return r;
+        if (n > maxLen) return __LINE__;
+        out.Clear();
+        if (n) {
+            out.Resize(n);
+        }
+        size_t i = 0;
+        while (true) {
+            size_t z, siz;
+            if (int r = dr.ReadVarInteger(z)) return r;
+            if (int r = dr.ReadVarInteger(siz)) return r;
+            if (!siz) break;
+            if (z > n - i || siz > n - i - z) return __LINE__;
+            Delta::CopyBase(out.buf, base, i, i + z);
+            i += z;
+            auto p = (uint8_t*)dr.ReadBuf(siz);
+            if (!p) return __LINE__;
+            for (size_t k = 0; k < siz; ++k) {
+                out.buf[i + k] = p[k] ^ Delta::At(base, i + k);
+            }
+            i += siz;
+        }
+        Delta::CopyBase(out.buf, base, i, n);
+        return 0;
+    }
+
+}
@@ -56,6 +56,25 @@ struct XXXXXXXXXXX {
         using Data::Data;
         SerdeInfo* si{};                            // need fill before use
         xx::Listi32<UdPtr> ptrs;                    // need clear after write finish
+        uint32_t epoch{};                           // != 0: epoch mode( ud = epoch << 32 | index ), no ptrs, no restore
+        uint32_t numPtrs{};                         // for epoch mode
+
+        // atomic: 多个 线程 同时 BeginEpoch 也 各得 不同的 epoch ( 同一对象图 仍 不可 多线程 同时 序列化 )
+        inline static std::atomic<uint32_t> lastEpoch{};
+
+        // begin epoch mode write( 64bit only ). ud's epoch == current epoch means "exists", so no need restore after write
+        // call it again before reuse this DataEx for next snapshot
+        void BeginEpoch() {
+            if constexpr (sizeof(size_t) >= 8) {
+                assert(!ptrs.len);
+                auto e = lastEpoch.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (e == 0) {                       // 0 means non-epoch mode
+                    e = lastEpoch.fetch_add(1, std::memory_order_relaxed) + 1;
+                }
+                epoch = e;
+                numPtrs = 0;
+            }
+        }
     };
 
     struct SerdeInfo {
@@ -65,12 +84,110 @@ struct XXXXXXXXXXX {
         std::array<Func, 65536> fs{};
         std::array<uint16_t, 65536> pids{};
 
+        // 紧凑表( Finalize 之后生效 ): typeId -> 稠密下标, 稠密下标 -> 创建函数 + 欧拉序区间( IsBaseOf O(1) )
+        struct TypeNode {
+            Func f;
+            uint32_t tin, tout;                     // 子孙的 tin 都在 ( tin, tout ] 之内
+        };
+        xx::Listi32<uint16_t> idxs;                 // typeId -> 稠密下标 + 1 ( 0: 不存在 ), len = 最大 typeId + 1
+        xx::Listi32<TypeNode> nodes;                // [0] 为 SerdeBase( typeId 0 )
+        bool finalized{};
+        bool useEpoch{};                            // MakeDataEx will call DataEx::BeginEpoch
+
         void Init() {
             memset(fs.data(), 0, sizeof(Func) * fs.size());
             memset(pids.data(), 0, sizeof(uint16_t) * pids.size());
+            idxs.Clear(true);
+            nodes.Clear(true);
+            finalized = false;
+        }
+
+        // 所有 Register 完成后调用, 生成紧凑表. 之后 IsBaseOf / GetFunc 只访问紧凑表. 再 Register 会退回 非紧凑模式
+        void Finalize() {
+            // 收集 已注册 及 作为父出现 的 typeId
+            int32_t maxId{};
+            for (int32_t i = 1; i < 65536; ++i) {
+                if (fs[i]) {
+                    maxId = std::max(maxId, std::max(i, (int32_t)pids[i]));
+                }
+            }
+            idxs.Clear();
+            idxs.Resize(maxId + 1);
+            memset(idxs.buf, 0, sizeof(uint16_t) * idxs.len);
+            xx::Listi32<uint16_t> ids;
+            ids.Emplace(uint16_t(0));
+            idxs[0] = 1;
+            for (int32_t i = 1; i <= maxId; ++i) {
+                if (fs[i] || idxs[i]) {
+                    if (!idxs[i]) {
+                        ids.Emplace((uint16_t)i);
+                        idxs[i] = (uint16_t)ids.len;
+                    }
+                    if (auto pid = pids[i]; pid && fs[i] && !idxs[pid]) {
+                        ids.Emplace(pid);
+                        idxs[pid] = (uint16_t)ids.len;
+                    }
+                }
+            }
+            // 建 子节点表( 链式 ), 无父 的 挂到 0 下
+            auto n = ids.len;
+            xx::Listi32<int32_t> firstChild, nextSibling;
+            firstChild.Resize(n);
+            nextSibling.Resize(n);
+            for (int32_t i = 0; i < n; ++i) {
+                firstChild[i] = nextSibling[i] = -1;
+            }
+            for (int32_t i = n - 1; i > 0; --i) {
+                auto id = ids[i];
+                auto pid = pids[id];
+                assert(pid != id);
+                auto pi = idxs[pid] - 1;
+                nextSibling[i] = firstChild[pi];
+                firstChild[pi] = i;
+            }
+            // 欧拉序
+            nodes.Clear();
+            nodes.Resize(n);
+            uint32_t t{};
+            xx::Listi32<int32_t> stack;
+            stack.Emplace(0);
+            nodes[0].tin = t++;
+            while (stack.len) {
+                auto i = stack.Top();
+                if (auto c = firstChild[i]; c != -1) {
+                    firstChild[i] = nextSibling[c];
+                    nodes[c].tin = t++;
+                    stack.Emplace(c);
+                } else {
+                    nodes[i].tout = t - 1;
+                    nodes[i].f = fs[ids[i]];
+                    stack.Pop();
+                }
+            }
+            finalized = true;
+        }
+
+        // 取创建函数. 返回 nullptr 表示 未注册
+        XX_INLINE Func GetFunc(uint16_t typeId) const noexcept {
+            if (finalized) {
+                if (typeId >= idxs.len) return nullptr;
+                if (auto i = idxs[typeId]) return nodes[i - 1].f;
+                return nullptr;
+            }
+            return fs[typeId];
         }
 
 		XX_INLINE bool IsBaseOf(uint16_t baseTypeId, uint16_t typeId) noexcept {
+            if (finalized) {
+                if (baseTypeId == typeId) return true;
+                auto ti = typeId < idxs.len ? idxs[typeId] : 0;
+                if (!ti) return !baseTypeId;        // 同 非紧凑模式: 任意 typeId 都视作 派生自 SerdeBase
+                auto bi = baseTypeId < idxs.len ? idxs[baseTypeId] : 0;
+                if (!bi) return false;
+                auto& b = nodes[bi - 1];
+                auto tin = nodes[ti - 1].tin;
+                return b.tin < tin && tin <= b.tout;
+            }
 			for (; typeId != baseTypeId; typeId = pids[typeId]) {
 				if (!typeId || typeId == pids[typeId]) return false;
 			}
@@ -94,6 +211,7 @@ struct XXXXXXXXXXX {
         XX_INLINE void Register() {
 			static_assert(std::is_base_of_v<SerdeBase, T>);
             assert(!fs[T::cTypeId]);
+            finalized = false;
 			pids[T::cTypeId] = T::cParentTypeId;
 			fs[T::cTypeId] = []() -> Shared<SerdeBase> { return ::xx::MakeShared<T>(); };
 		}
@@ -101,13 +219,18 @@ struct XXXXXXXXXXX {
         template<typename T = SerdeBase>
         XX_INLINE Shared<T> MakeShared(uint16_t const& typeId) {
             static_assert(std::is_base_of_v<SerdeBase, T>);
-            if (!typeId || !fs[typeId] || !IsBaseOf<T>(typeId)) return nullptr;
-			return fs[typeId]().Cast<T>();
+            if (!typeId) return nullptr;
+            auto f = GetFunc(typeId);
+            if (!f || !IsBaseOf<T>(typeId)) return nullptr;
+			return f().Cast<T>();
 		}
 
         XX_INLINE DataEx MakeDataEx() {
             DataEx d;
             d.si = this;
+            if (useEpoch) {
+                d.BeginEpoch();
+            }
             return d;
         }
 
@@ -167,8 +290,22 @@ struct XXXXXXXXXXX {
                 d.WriteFixed<needReserve>((uint8_t)0);              // index( nullptr ) same as WriteVar(size_t 0)
             } else {
                 auto h = in.GetHeader();
-                if (h->ud == 0) {                   // first time
-                    auto& ptrs = ((DataEx&)d).ptrs;
+                auto& dx = (DataEx&)d;
+                if constexpr (sizeof(size_t) >= 8) {
+                    if (dx.epoch) {
+                        if ((h->ud >> 32) != dx.epoch) {    // first time
+                            h->ud = ((size_t)dx.epoch << 32) | ++dx.numPtrs;
+                            d.WriteVarInteger<needReserve>(dx.numPtrs);     // index
+                            d.WriteVarInteger<needReserve>(in->typeId);     // type id
+                            in->WriteTo(d);                                 // content
+                        } else {                            // exists
+                            d.WriteVarInteger<needReserve>((uint32_t)h->ud);    // index
+                        }
+                        return;
+                    }
+                }
+                if (h->ud == 0 || IsEpochUd(h->ud)) {   // first time
+                    auto& ptrs = dx.ptrs;
                     ptrs.Emplace(&h->ud);           // for restore
                     h->ud = (size_t)ptrs.len;       // store index
                     d.WriteVarInteger<needReserve>(h->ud);          // index
@@ -180,6 +317,15 @@ struct XXXXXXXXXXX {
             }
         }
 
+        // ud left by epoch mode
+        XX_INLINE static bool IsEpochUd(size_t ud) {
+            if constexpr (sizeof(size_t) >= 8) {
+                return (ud >> 32) != 0;
+            } else {
+                return false;
+            }
+        }
+
         static inline int Read(Data_r& dr, T& out) {
             size_t idx;
             if (int r = dr.Read(idx)) return r;                     // index
@@ -195,7 +341,7 @@ struct XXXXXXXXXXX {
                 uint16_t typeId;
                 if (int r = dr.Read(typeId)) return r;              // type id
                 if (!typeId) return __LINE__;
-                if (!si.fs[typeId]) return __LINE__;
+                if (!si.GetFunc(typeId)) return __LINE__;
                 if (!si.IsBaseOf<U>(typeId)) return __LINE__;
 
                 if (!out || out->typeId != typeId) {
@@ -0,0 +1,118 @@
+﻿#pragma once
+#include "xx_typetraits.h"
+
+namespace xx {
+
+    // Data / DataShared 的 buf 内存池: 2^n 尺寸分级 + thread_local 空闲链表, 附带 命中 / 未命中 计数( 每线程 )
+    // 需定义 XX_DATA_USE_POOL 才会被 Data_rw / DataShared 使用( 否则依旧 new[] / delete[] )
+    // 每块前面有 hLen 字节隐藏头 记录分级, 故 Free 只需指针. 跨线程 Free 也安全: 块会进入 释放线程 的空闲链表
+    struct DataPool {
+        static constexpr size_t minShift = 6;                               // 最小块 64 字节
+        static constexpr size_t maxShift = 20;                              // 最大块 1M, 更大的直接 new / delete
+        static constexpr size_t numClasses = maxShift - minShift + 1;
+        static constexpr size_t hLen = 16;                                  // 隐藏头长度( 保持 16 字节对齐 )
+        static constexpr size_t maxCacheBytesPerClass = 1024 * 1024;        // 每级 每线程 最多缓存字节数( 超出直接释放 )
+        static constexpr uint8_t bigFlag = 0xFF;
+
+        struct Counters {
+            size_t hits{}, misses{}, frees{}, drops{}, bigs{};
+        };
+
+        struct Node {
+            Node* next;
+        };
+
+        struct ThreadCache {
+            std::array<Node*, numClasses> heads{};
+            std::array<size_t, numClasses> counts{};
+            Counters counters;
+
+            ~ThreadCache() {
+                Trim();
+                dead = true;
+            }
+
+            // 释放所有缓存块
+            void Trim() {
+                for (size_t i = 0; i < numClasses; ++i) {
+                    while (auto n = heads[i]) {
+                        heads[i] = n->next;
+                        delete[]((uint8_t*)n - hLen);
+                    }
+                    counts[i] = 0;
+                }
+            }
+        };
+
+        // 线程退出后 ThreadCache 已析构, 之后的 Alloc / Free 直接走 new / delete
+        inline static thread_local bool dead{};
+
+        XX_INLINE static ThreadCache& TC() {
+            thread_local ThreadCache tc;
+            return tc;
+        }
+
+        XX_INLINE static size_t CalcClass(size_t siz) {
+            if (siz <= (size_t(1) << minShift)) return 0;
+            return Calc2n(siz - 1) + 1 - minShift;
+        }
+
+        XX_INLINE static size_t MaxCacheCount(size_t idx) {
+            auto n = maxCacheBytesPerClass >> (idx + minShift);
+            return n < 4 ? 4 : n;
+        }
+
+        // 分配至少 siz 字节. 返回的指针 需用 Free 释放
+        XX_INLINE static uint8_t* Alloc(size_t siz) {
+            auto idx = CalcClass(siz);
+            if (idx >= numClasses) {
+                auto p = new uint8_t[hLen + siz];
+                p[0] = bigFlag;
+                if (!dead) ++TC().counters.bigs;
+                return p + hLen;
+            }
+            if (!dead) {
+                auto& tc = TC();
+                if (auto n = tc.heads[idx]) {
+                    tc.heads[idx] = n->next;
+                    --tc.counts[idx];
+                    ++tc.counters.hits;
+                    return (uint8_t*)n;
+                }
+                ++tc.counters.misses;
+            }
+            auto p = new uint8_t[hLen + (size_t(1) << (idx + minShift))];
+            p[0] = (uint8_t)idx;
+            return p + hLen;
+        }
+
+        XX_INLINE static void Free(void* ptr) {
+            auto p = (uint8_t*)ptr - hLen;
+            auto idx = (size_t)p[0];
+            if (idx != bigFlag && !dead) {
+                auto& tc = TC();
+                ++tc.counters.frees;
+                if (tc.counts[idx] < MaxCacheCount(idx)) {
+                    auto n = (Node*)ptr;
+                    n->next = tc.heads[idx];
+                    tc.heads[idx] = n;
+                    ++tc.counts[idx];
+                    return;
+                }
+                ++tc.counters.drops;
+            }
+            delete[](p);
+        }
+
+        // 当前线程的计数
+        static Counters const& GetCounters() {
+            return TC().counters;
+        }
+
+        // 释放当前线程的缓存块
+        static void Trim() {
+            if (!dead) TC().Trim();
+        }
+    };
+
+}
@@ -66,7 +66,7 @@ namespace xx {
 		XX_INLINE void Clear() {
 			if (h) {
 				if (--h->numRefs == 0) {
-					delete[](h);
+					DataFree((uint8_t*)h);
 				}
 				h = nullptr;
 			}
@@ -95,4 +95,120 @@ namespace xx {
     // mem moveable tag
     template<>
     struct IsPod<DataShared, void> : std::true_type {};
+
+
+	// DataShared 的 线程安全版( 引用计数为原子操作, Header 内存布局相同 ), 可将同一份数据 交给 多个线程( 不同 io_context ) 发送
+	struct AtomicDataShared {
+
+		struct Header {
+			size_t len;
+			std::atomic<size_t> numRefs;
+		};
+		static constexpr size_t hLen = Data::GetBufHeaderReserveLen();
+		static_assert(hLen >= sizeof(Header));
+		static_assert(sizeof(Header) == sizeof(DataShared::Header) && offsetof(Header, numRefs) == offsetof(DataShared::Header, numRefs));
+		static_assert(std::atomic<size_t>::is_always_lock_free);
+
+		Header* h;
+
+		// 供 if 简单判断是否为空
+		XX_INLINE operator bool() const {
+			return h != nullptr;
+		}
+
+		XX_INLINE AtomicDataShared() : h(nullptr) {}
+
+		XX_INLINE AtomicDataShared(Data&& d)
+			: h(Attach(std::move(d))) {
+		}
+
+		// 从 DataShared 转换: 引用计数为 1 时 直接接管 Header( 不复制 ), 否则 复制一份数据
+		XX_INLINE AtomicDataShared(DataShared&& ds) {
+			if (!ds) {
+				h = nullptr;
+			}
+			else if (ds.h->numRefs == 1) {
+				h = (Header*)ds.h;
+				std::construct_at(&h->numRefs, 1);
+				ds.h = nullptr;
+			}
+			else {
+				h = Attach(Data(ds.GetBuf(), ds.GetLen()));
+				ds.Clear();
+			}
+		}
+
+		XX_INLINE AtomicDataShared(AtomicDataShared const& ds)
+			: h(ds.h) {
+			if (h) {
+				assert(h->numRefs.load(std::memory_order_relaxed) > 0);
+				h->numRefs.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		AtomicDataShared(AtomicDataShared&& ds) noexcept
+			: h(ds.h) {
+			ds.h = nullptr;
+		}
+
+		XX_INLINE AtomicDataShared& operator=(AtomicDataShared const& ds) {
+			if (h == ds.h) return *this;
+			Clear();
+			h = ds.h;
+			if (h) {
+				assert(h->numRefs.load(std::memory_order_relaxed) > 0);
+				h->numRefs.fetch_add(1, std::memory_order_relaxed);
+			}
+			return *this;
+		}
+
+		XX_INLINE AtomicDataShared& operator=(AtomicDataShared&& ds) noexcept {
+			std::swap(h, ds.h);
+			return *this;
+		}
+
+		XX_INLINE void Clear() {
+			if (h) {
+				if (h->numRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					std::destroy_at(&h->numRefs);
+					DataFree((uint8_t*)h);
+				}
+				h = nullptr;
+			}
+		}
+
+		~AtomicDataShared() {
+			Clear();
+		}
+
+		XX_INLINE uint8_t* GetBuf() const {
+			if (h) return (uint8_t*)h + hLen;
+			else return nullptr;
+		}
+
+		XX_INLINE size_t GetLen() const {
+			if (h) return h->len;
+			else return 0;
+		}
+
+		XX_INLINE size_t GetNumRefs() const {
+			if (h) return h->numRefs.load(std::memory_order_relaxed);
+			else return 0;
+		}
+
+	protected:
+		// 接管 d 的 buf, 填充 Header
+		XX_INLINE static Header* Attach(Data&& d) {
+			if (!d) return nullptr;
+			auto h = (Header*)(d.buf - hLen);
+			h->len = d.len;
+			std::construct_at(&h->numRefs, 1);
+			d.Reset();
+			return h;
+		}
+	};
+
+    // mem moveable tag
+    template<>
+    struct IsPod<AtomicDataShared, void> : std::true_type {};
 }
@@ -0,0 +1,172 @@
+﻿#pragma once
+#include "xx_data_shared.h"
+
+namespace xx {
+
+	// 环形缓冲 流式读取器: 从 tcp 等流中 拆出 "定长 长度头 + 数据" 的完整帧, 帧数据 不搬移( 不再 RemoveFront memmove )
+	// 跨越环尾的帧 复制一次 到 临时 Data. Next 得到的 Data_r 可直接 Read(...), 在 下次 GetWriteSpace / Write / Next 之前 有效
+	// example:
+	//      xx::DataStreamReader<> dsr;
+	//      auto s = dsr.GetWriteSpace();  n = recv(fd, s.buf, s.len);  dsr.Commit(n);
+	//      xx::Data_r dr;
+	//      while (0 == (r = dsr.Next(dr))) { ... dr.Read(...) ... }
+	//      if (r != dsr.needMore) { error }
+	template<typename LenType = uint32_t, bool lenBigEndian = false>
+	struct DataStreamReader {
+		static_assert(std::is_unsigned_v<LenType>);
+		static constexpr size_t hLen = sizeof(LenType);
+		static constexpr int needMore = -1;		// Next 的返回值: 数据不足一帧
+
+		Data ring;				// 环形缓冲( len == cap == 2^n )
+		size_t head{}, tail{};	// 读 / 写 位置( 只增不减, & mask 得到下标 )
+		size_t mask;
+		size_t maxFrameLen;		// 超过该长度的帧 视为错误
+		Data tmp;				// 跨越环尾的帧 复制到这里
+		bool lastInTmp{};
+
+		explicit DataStreamReader(size_t cap = 65536, size_t maxFrameLen_ = 16 * 1024 * 1024)
+			: maxFrameLen(maxFrameLen_) {
+			cap = Round2n(cap < 64 ? 64 : cap);
+			ring.Reserve<false, false>(cap);		// 不 round2n( 否则 加上 头部预留 后 翻倍 )
+			ring.len = cap;
+			mask = cap - 1;
+		}
+		DataStreamReader(DataStreamReader const&) = delete;
+		DataStreamReader& operator=(DataStreamReader const&) = delete;
+
+		// 未读数据长度
+		XX_INLINE size_t GetLen() const {
+			return tail - head;
+		}
+
+		XX_INLINE size_t GetCap() const {
+			return ring.len;
+		}
+
+		// 返回一段 连续 可写空间( 长度 >= minSiz, 空间不足 则扩容 ). 写入后 Commit 实际写入长度
+		Span GetWriteSpace(size_t minSiz = 1) {
+			if (head == tail) {
+				head = tail = 0;	// 空了就回到开头, 尽量避免跨越环尾
+			}
+			if (ring.len - GetLen() < minSiz) {
+				Grow(GetLen() + minSiz);
+			}
+			auto t = tail & mask;
+			auto n = std::min(ring.len - GetLen(), ring.len - t);
+			if (n < minSiz) {
+				Grow(GetLen() + minSiz);
+				t = tail;
+				n = ring.len - tail;
+			}
+			return { ring.buf + t, n };
+		}
+
+		XX_INLINE void Commit(size_t n) {
+			assert(GetLen() + n <= ring.len);
+			tail += n;
+		}
+
+		// 复制写入( 不方便直接 recv 到 GetWriteSpace 时 )
+		void Write(void const* buf, size_t len) {
+			auto p = (uint8_t const*)buf;
+			while (len) {
+				auto s = GetWriteSpace();
+				auto n = std::min(s.len, len);
+				memcpy(s.buf, p, n);
+				Commit(n);
+				p += n;
+				len -= n;
+			}
+		}
+
+		// 尝试取出一帧( 不含长度头 ). 返回 0: 成功; needMore: 数据不足; 其他: 出错( 长度超限 )
+		int Next(Data_r& out) {
+			auto len = GetLen();
+			if (len < hLen) return needMore;
+
+			// 读长度头( 可能跨越环尾 )
+			uint8_t hb[hLen];
+			auto h = head & mask;
+			if (h + hLen <= ring.len) {
+				memcpy(hb, ring.buf + h, hLen);
+			} else {
+				auto n = ring.len - h;
+				memcpy(hb, ring.buf + h, n);
+				memcpy(hb + n, ring.buf, hLen - n);
+			}
+			LenType fl;
+			Data_r hdr(hb, hLen);
+			if constexpr (lenBigEndian) {
+				(void)hdr.ReadFixedBE(fl);
+			} else {
+				(void)hdr.ReadFixed(fl);
+			}
+			auto siz = (size_t)fl;
+			if (siz > maxFrameLen) return __LINE__;
+			if (len < hLen + siz) {
+				if (hLen + siz > ring.len) {
+					Grow(hLen + siz);	// 帧比环大: 扩容, 以便后续写入
+				}
+				return needMore;
+			}
+
+			// 帧数据 连续 则直接引用, 否则 复制一次
+			auto b = (head + hLen) & mask;
+			if (b + siz <= ring.len) {
+				out.Reset(ring.buf + b, siz);
+				lastInTmp = false;
+			} else {
+				auto n = ring.len - b;
+				tmp.Clear();
+				tmp.Reserve(siz);
+				tmp.WriteBuf<false>(ring.buf + b, n);
+				tmp.WriteBuf<false>(ring.buf, siz - n);
+				out.Reset(tmp.buf, tmp.len);
+				lastInTmp = true;
+			}
+			head += hLen + siz;
+			return 0;
+		}
+
+		// 同上, 结果复制到 DataShared ( 方便 跨协程 / 广播 持有 ). 跨越环尾的帧 直接 move 临时 Data, 不会复制两次
+		int Next(DataShared& out) {
+			Data_r dr;
+			if (int r = Next(dr)) return r;
+			if (lastInTmp) {
+				out = DataShared(std::move(tmp));
+			} else {
+				Data d;
+				d.WriteBuf(dr.buf, dr.len);
+				out = DataShared(std::move(d));
+			}
+			return 0;
+		}
+
+		void Clear() {
+			head = tail = 0;
+			tmp.Clear();
+		}
+
+	protected:
+		// 扩容到 >= siz, 未读数据 移到开头( 会令之前 Next 得到的 Data_r 失效 )
+		void Grow(size_t siz) {
+			auto cap = Round2n(siz);
+			if (cap <= ring.len) {
+				cap = ring.len * 2;
+			}
+			Data d;
+			d.Reserve<false, false>(cap);
+			d.len = cap;
+			auto len = GetLen();
+			auto h = head & mask;
+			auto n = std::min(len, ring.len - h);
+			memcpy(d.buf, ring.buf + h, n);
+			memcpy(d.buf + n, ring.buf, len - n);
+			ring = std::move(d);
+			mask = cap - 1;
+			head = 0;
+			tail = len;
+		}
+	};
+
+}
@@ -271,4 +271,8 @@ namespace xx {
         }
     };
 
+    template<typename T>
+    struct DataMaxSize<T, std::enable_if_t<std::is_base_of_v<FX64, T>>>
+        : std::integral_constant<size_t, sizeof(FX64::value)> {};
+
 }
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <fstream>
 #include <filesystem>
@@ -78,6 +79,16 @@ using namespace std::chrono_literals;
 #   include <arpa/inet.h>  // __BYTE_ORDER __LITTLE_ENDIAN __BIG_ENDIAN
 #endif
 
+// simd( enable by compiler flags: -mavx2 / -msse4.1 / /arch:AVX2 )
+#if defined(__AVX2__)
+#   define XX_SIMD_AVX2
+#   define XX_SIMD_SSE4
+#   include <immintrin.h>
+#elif defined(__SSE4_1__)
+#   define XX_SIMD_SSE4
+#   include <immintrin.h>
+#endif
+
 #ifndef XX_NOINLINE
 #   ifndef NDEBUG
 #       define XX_NOINLINE
@@ -122,6 +133,17 @@ using namespace std::chrono_literals;
 #    define XX_LIKELY(x)                 __builtin_expect((x), 1)
 #endif
 
+// software prefetch( read, keep in all cache levels )
+#ifdef _MSC_VER
+#   if defined(_M_X64) || defined(_M_IX86)
+#       define XX_PREFETCH(p)           _mm_prefetch((char const*)(p), _MM_HINT_T0)
+#   else
+#       define XX_PREFETCH(p)           __prefetch((void const*)(p))
+#   endif
+#else
+#    define XX_PREFETCH(p)               __builtin_prefetch((p))
+#endif
+
 // __restrict like?
 #if defined(__clang__)
 #  define XX_ASSUME(e) __builtin_assume(e)
@@ -322,15 +322,7 @@ namespace xx {
 			if constexpr (sizeof(U) == 1 || std::is_floating_point_v<U>) {
 				d.WriteFixedArray<needReserve>(in.Buf(), inLen);
 			} else if constexpr (std::is_integral_v<U>) {
-				if constexpr (needReserve) {
-					auto cap = (size_t)inLen * (sizeof(U) + 2);
-					if (d.cap < cap) {
-						d.Reserve<false>(cap);
-					}
-				}
-				for (S i = 0; i < inLen; ++i) {
-					d.WriteVarInteger<false>(in[i]);
-				}
+				d.WriteVarIntegerArray<needReserve>(in.Buf(), (size_t)inLen);
 			} else {
 				for (S i = 0; i < inLen; ++i) {
 					d.Write<needReserve>(in[i]);
@@ -346,6 +338,8 @@ namespace xx {
 			auto buf = out.Buf();
 			if constexpr (sizeof(U) == 1 || std::is_floating_point_v<U>) {
 				if (int r = d.ReadFixedArray(buf, siz)) return r;
+			} else if constexpr (std::is_integral_v<U>) {
+				if (int r = d.ReadVarIntegerArray(buf, siz)) return r;
 			} else {
 				for (size_t i = 0; i < siz; ++i) {
 					if (int r = d.Read(buf[i])) return r;
@@ -6,6 +6,7 @@ namespace xx {
     // texture uv mapping pos
     struct UV {
         uint16_t u, v;
+        XX_DATA_FIELDS(u, v)
     };
 
     template<typename T>
@@ -15,17 +16,6 @@ namespace xx {
         }
     };
 
-    template<typename T>
-    struct DataFuncs<T, std::enable_if_t<std::is_same_v<UV, std::remove_cvref_t<T>>>> {
-        template<bool needReserve = true>
-        static inline void Write(Data& d, T const& in) {
-            d.Write<needReserve>(in.u, in.v);
-        }
-        static inline int Read(Data_r& d, T& out) {
-            return d.Read(out.u, out.v);
-        }
-    };
-
 
     // 3 bytes color
     struct RGB8 {
@@ -59,6 +49,9 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<RGB8, void> : std::integral_constant<size_t, 3> {};
+
 
     // 4 bytes color
     struct RGBA8 {
@@ -93,6 +86,12 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<RGBA8, void> : std::integral_constant<size_t, 4> {};
+
+    template<>
+    struct DataRawLayout<RGBA8, void> : std::true_type {};
+
 
     // 4 floats color
     struct RGBA {
@@ -143,6 +142,12 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<RGBA, void> : std::integral_constant<size_t, sizeof(float) * 4> {};
+
+    template<>
+    struct DataRawLayout<RGBA, void> : std::true_type {};
+
 
     // pos + size
     struct Rect : XY {
@@ -167,6 +172,9 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<Rect, void> : std::integral_constant<size_t, sizeof(float) * 4> {};
+
     struct PosRadius {
         XY pos;
         float radius;
@@ -190,6 +198,9 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<PosRadius, void> : std::integral_constant<size_t, sizeof(float) * 3> {};
+
     union UVRect {
         struct {
             uint16_t x, y, w, h;
@@ -215,6 +226,9 @@ namespace xx {
         }
     };
 
+    template<>
+    struct DataMaxSize<UVRect, void> : std::integral_constant<size_t, DataMaxSize_v<uint16_t> * 4> {};
+
 
     /*******************************************************************************************************************************************/
     /*******************************************************************************************************************************************/
@@ -1,5 +1,6 @@
 ﻿#pragma once
-#include "xx_typetraits.h"
+#include "xx_ptr_pool.h"
+#include "xx_ptr_census.h"
 
 // std::shared_ptr / weak_ptr likely but thin, no atomic( fast 4 times ), a little unsafe for easy use
 
@@ -32,6 +33,56 @@ namespace xx {
         return container_of(p, HT, data);
     }
 
+    // PtrHeader 的 分配与释放( 定义 XX_PTR_USE_POOL 则走 PtrPool )
+    template<typename HT>
+    XX_INLINE HT* PtrAlloc() {
+#ifdef XX_PTR_USE_POOL
+        static_assert(alignof(HT) <= PtrPool::maxAlign);
+        return (HT*)PtrPool::Alloc(sizeof(HT), alignof(HT));
+#else
+        return (HT*) new MyAlignedStorage<HT>();
+#endif
+    }
+
+    template<typename HT>
+    XX_INLINE void PtrFree(HT* h) {
+#ifdef XX_PTR_USE_POOL
+        PtrPool::Free(h);
+#else
+        // h 可能是 基类 的 header ( 实际分配的是 派生类 ), 故 不带长度 释放
+        if constexpr (alignof(HT) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(h, std::align_val_t(alignof(HT)));
+        } else {
+            ::operator delete(h);
+        }
+#endif
+    }
+
+#ifdef XX_PTR_CENSUS
+    // 分配 / 析构 时 记录 到 PtrCensus
+    template<typename U>
+    XX_INLINE void PtrCensusAlloc() {
+        PtrCensus::OnAlloc(typeid(U));
+    }
+
+    // 非虚析构 的 类型 在 PtrDelete<U> 中 记录( 那里 知道 分配时 的 类型 )
+    template<typename T>
+    XX_INLINE void PtrCensusFree(T* p) {
+        if constexpr (std::has_virtual_destructor_v<T>) {
+            PtrCensus::OnFree(typeid(*p));
+        }
+    }
+#endif
+
+    // 非虚析构 类型 的 deleter ( 存于 header )
+    template<typename U>
+    void PtrDelete(void* o) {
+#ifdef XX_PTR_CENSUS
+        PtrCensus::OnFree(typeid(U));
+#endif
+        std::destroy_at((U*)o);
+    }
+
     template<typename T, typename ENABLED = void>
     struct PtrHeaderSwitcher {
         using type = PtrHeader<T>;
@@ -234,6 +285,9 @@ namespace xx {
                 assert(h->sharedCount);
                 // think about field weak point to self
                 if (h->sharedCount == 1) {
+#ifdef XX_PTR_CENSUS
+                    PtrCensusFree(pointer);
+#endif
                     if constexpr (!std::has_virtual_destructor_v<T>) {
                         h->deleter(pointer);
                     } else {
@@ -242,12 +296,12 @@ namespace xx {
                     pointer = {};
                     if constexpr (weakSupport) {
                         if (h->weakCount == 0) {
-                            delete (MyAlignedStorage<HeaderType>*)h;
+                            PtrFree(h);
                         } else {
                             h->sharedCount = 0;
                         }
                     } else {
-                        delete (MyAlignedStorage<HeaderType>*)h;
+                        PtrFree(h);
                     }
                 } else {
                     --h->sharedCount;
@@ -278,15 +332,18 @@ namespace xx {
             static_assert(PtrAlignCheck_v<T, U>);
             using HT = typename S<U>::HeaderType;
             Reset();
-            auto h = (HT*) new MyAlignedStorage<HT>();
+            auto h = PtrAlloc<HT>();
             h->Init();
             pointer = (T*)&h->data;
             if constexpr (!std::has_virtual_destructor_v<T>) {
-                h->deleter = [](void* o) { std::destroy_at((U*)o); };
+                h->deleter = &PtrDelete<U>;
             } else {
                 h->deleter = {};
             }
             std::construct_at(&h->data, std::forward<Args>(args)...);
+#ifdef XX_PTR_CENSUS
+            PtrCensusAlloc<U>();
+#endif
             if constexpr (HasMemberType_cParentTypeId<T>) {
                 pointer->typeId = T::cTypeId;
             }
@@ -362,7 +419,7 @@ namespace xx {
         void Reset() {
             if (h) {
                 if (h->weakCount == 1 && h->sharedCount == 0) {
-                    delete (MyAlignedStorage<HeaderType>*)h;
+                    PtrFree(h);
                 } else {
                     --h->weakCount;
                 }
@@ -0,0 +1,132 @@
+﻿#pragma once
+#include "xx_typetraits.h"
+#include <typeindex>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+namespace xx {
+
+    // Shared / Ref / SharedMT 对象 统计( 按类型 ): 存活数, 峰值, 分配 / 释放 总数, 每帧 分配 / 释放 数. 用于 排查 泄露 与 热点分配
+    // 需定义 XX_PTR_CENSUS 才会在 Emplace / Reset 中 记录( 有锁, 仅供 调试 / CI ). 每帧 调用 NextFrame ( FpsViewer 会自动调用 )
+    // 类型识别: 有虚析构 的 用 typeid(*p) ( 派生类 按 实际类型 统计 ), 否则 在 deleter ( PtrDelete<U> ) 中 用 typeid(U)
+    struct PtrCensus {
+        struct Entry {
+            std::string name;
+            int64_t live{}, peak{}, allocs{}, frees{};
+            int64_t frameAllocs{}, frameFrees{};            // 当前帧
+            int64_t lastFrameAllocs{}, lastFrameFrees{};    // 上一帧
+        };
+
+        std::mutex mtx;
+        std::unordered_map<std::type_index, Entry> entries;
+        int64_t frameAllocs{}, lastFrameAllocs{}, frameFrees{}, lastFrameFrees{};
+
+        static PtrCensus& Instance() {
+            static PtrCensus pc;
+            return pc;
+        }
+
+        Entry& GetEntry(std::type_info const& ti) {
+            auto& e = entries[ti];
+            if (e.name.empty()) {
+#ifdef __GNUC__
+                int r{};
+                auto n = abi::__cxa_demangle(ti.name(), nullptr, nullptr, &r);
+                e.name = n ? n : ti.name();
+                free(n);
+#else
+                e.name = ti.name();
+#endif
+            }
+            return e;
+        }
+
+        static void Alloc(Entry& e) {
+            ++e.allocs;
+            ++e.frameAllocs;
+            if (++e.live > e.peak) {
+                e.peak = e.live;
+            }
+        }
+
+        static void Free(Entry& e) {
+            ++e.frees;
+            ++e.frameFrees;
+            --e.live;
+        }
+
+        // 分配后 调用
+        static void OnAlloc(std::type_info const& ti) {
+            auto& pc = Instance();
+            std::scoped_lock<std::mutex> g(pc.mtx);
+            Alloc(pc.GetEntry(ti));
+            ++pc.frameAllocs;
+        }
+
+        // 析构前 调用
+        static void OnFree(std::type_info const& ti) {
+            auto& pc = Instance();
+            std::scoped_lock<std::mutex> g(pc.mtx);
+            Free(pc.GetEntry(ti));
+            ++pc.frameFrees;
+        }
+
+        // 帧结束: 当前帧计数 转为 上一帧
+        static void NextFrame() {
+            auto& pc = Instance();
+            std::scoped_lock<std::mutex> g(pc.mtx);
+            for (auto& [k, e] : pc.entries) {
+                e.lastFrameAllocs = std::exchange(e.frameAllocs, 0);
+                e.lastFrameFrees = std::exchange(e.frameFrees, 0);
+            }
+            pc.lastFrameAllocs = std::exchange(pc.frameAllocs, 0);
+            pc.lastFrameFrees = std::exchange(pc.frameFrees, 0);
+        }
+
+        // 上一帧 总分配数( CI 可据此 检查 热路径 分配 )
+        static int64_t GetLastFrameAllocs() {
+            auto& pc = Instance();
+            std::scoped_lock<std::mutex> g(pc.mtx);
+            return pc.lastFrameAllocs;
+        }
+
+        // 总存活数
+        static int64_t GetLive() {
+            auto& pc = Instance();
+            std::scoped_lock<std::mutex> g(pc.mtx);
+            int64_t r{};
+            for (auto& [k, e] : pc.entries) r += e.live;
+            return r;
+        }
+
+        // 复制所有类型的统计 ( 按 存活数 降序 )
+        static std::vector<Entry> GetEntries() {
+            std::vector<Entry> r;
+            {
+                auto& pc = Instance();
+                std::scoped_lock<std::mutex> g(pc.mtx);
+                for (auto& [k, e] : pc.entries) r.push_back(e);
+            }
+            std::sort(r.begin(), r.end(), [](Entry const& a, Entry const& b) {
+                return a.live > b.live || (a.live == b.live && a.allocs > b.allocs);
+            });
+            return r;
+        }
+
+        // 文本报表( 每行一个类型, 最多 topN 行 )
+        static std::string Dump(size_t topN = 30) {
+            std::string s = "live\tpeak\tallocs\tfrees\tframe+\tframe-\ttype\n";
+            auto es = GetEntries();
+            for (size_t i = 0, e = std::min(topN, es.size()); i < e; ++i) {
+                auto& o = es[i];
+                s += std::to_string(o.live) + '\t' + std::to_string(o.peak)
+                    + '\t' + std::to_string(o.allocs) + '\t' + std::to_string(o.frees)
+                    + '\t' + std::to_string(o.lastFrameAllocs) + '\t' + std::to_string(o.lastFrameFrees)
+                    + '\t' + o.name + '\n';
+            }
+            return s;
+        }
+    };
+
+}
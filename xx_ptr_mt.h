@@ -0,0 +1,325 @@
+﻿#pragma once
+#include "xx_ptr.h"
+
+// Shared / Weak 的 原子引用计数 版本: 可跨线程 传递 / 持有( 例如 把 贴图 / 帧 / 骨骼数据 交给 加载线程 ). 对象本身 的 访问 依旧需要 自行同步
+// header 布局 与 PtrHeader 相同, 分配 同样走 PtrAlloc / PtrFree. 只在 确实需要跨线程 时使用, 游戏线程内 继续用 Shared( 原子操作 慢数倍 )
+
+namespace xx {
+
+    template<typename T>
+    struct PtrHeaderMT {
+        std::atomic<uint32_t> sharedCount;
+        std::atomic<uint32_t> weakCount;                // 所有 SharedMT 共同持有 1 个 weak, 故 sharedCount 归 0 后 才可能 归 0
+        union {
+            PtrDeleter deleter;
+            size_t ud;
+        };
+        T data;
+        XX_INLINE void Init() {
+            sharedCount.store(1, std::memory_order_relaxed);
+            weakCount.store(1, std::memory_order_relaxed);
+        }
+    };
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+    static_assert(sizeof(PtrHeaderMT<size_t>) == sizeof(PtrHeader<size_t>));
+
+    template<typename T>
+    struct WeakMT;
+
+    /***********************************************************************************************/
+
+    template<typename T>
+    struct SharedMT {
+        using HeaderType = PtrHeaderMT<T>;
+        using ElementType = T;
+        T* pointer{};
+
+        operator bool() const {
+            return pointer != nullptr;
+        }
+
+        bool Empty() const {
+            return pointer == nullptr;
+        }
+
+        T* operator->() const {
+            return pointer;
+        }
+
+        T const& Value() const {
+            return *pointer;
+        }
+
+        T& Value() {
+            return *pointer;
+        }
+
+        SharedMT() = default;
+
+        // unsafe: ptr 必须来自 SharedMT
+        template<typename U>
+        explicit SharedMT(U* ptr) : pointer(ptr) {
+            static_assert(std::is_base_of_v<T, U> || std::is_same_v<T, U>);
+            static_assert(PtrAlignCheck_v<T, U>);
+            if (ptr) {
+                CalcPtrHeader<HeaderType>(ptr)->sharedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        SharedMT(SharedMT const& o) : SharedMT(o.pointer) {}
+
+        template<typename U>
+        SharedMT(SharedMT<U> const& o) : SharedMT(o.pointer) {}
+
+        SharedMT(SharedMT&& o) noexcept : pointer(std::exchange(o.pointer, nullptr)) {}
+
+        template<typename U>
+        SharedMT(SharedMT<U>&& o) noexcept : pointer(std::exchange(o.pointer, nullptr)) {
+            static_assert(std::is_base_of_v<T, U> || std::is_same_v<T, U>);
+            static_assert(PtrAlignCheck_v<T, U>);
+        }
+
+        SharedMT& operator=(SharedMT const& o) {
+            SharedMT(o).Swap(*this);
+            return *this;
+        }
+
+        template<typename U>
+        SharedMT& operator=(SharedMT<U> const& o) {
+            SharedMT(o).Swap(*this);
+            return *this;
+        }
+
+        SharedMT& operator=(SharedMT&& o) noexcept {
+            std::swap(pointer, o.pointer);
+            return *this;
+        }
+
+        template<typename U>
+        SharedMT& operator=(SharedMT<U>&& o) noexcept {
+            SharedMT(std::move(o)).Swap(*this);
+            return *this;
+        }
+
+        XX_INLINE void Swap(SharedMT& o) noexcept {
+            std::swap(pointer, o.pointer);
+        }
+
+        template<typename U>
+        bool operator==(SharedMT<U> const& o) const {
+            return pointer == o.pointer;
+        }
+
+        template<typename U>
+        bool operator!=(SharedMT<U> const& o) const {
+            return pointer != o.pointer;
+        }
+
+        template<typename U>
+        SharedMT<U> As() const {
+            static_assert(PtrAlignCheck_v<T, U>);
+            if constexpr (std::is_same_v<U, T> || std::is_base_of_v<U, T>) {
+                return SharedMT<U>(pointer);
+            } else {
+                return SharedMT<U>(dynamic_cast<U*>(pointer));
+            }
+        }
+
+        // unsafe
+        XX_INLINE HeaderType* GetHeader() const {
+            return CalcPtrHeader<HeaderType>(pointer);
+        }
+
+        // 仅供参考( 其他线程 可能同时在改 )
+        uint32_t GetSharedCount() const {
+            if (!pointer) return 0;
+            return GetHeader()->sharedCount.load(std::memory_order_relaxed);
+        }
+
+        uint32_t GetWeakCount() const {
+            if (!pointer) return 0;
+            return GetHeader()->weakCount.load(std::memory_order_relaxed) - 1;
+        }
+
+        void Reset() {
+            if (pointer) {
+                auto h = GetHeader();
+                if (h->sharedCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+#ifdef XX_PTR_CENSUS
+                    PtrCensusFree(pointer);
+#endif
+                    if constexpr (!std::has_virtual_destructor_v<T>) {
+                        h->deleter(pointer);
+                    } else {
+                        std::destroy_at(pointer);
+                    }
+                    if (h->weakCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        PtrFree(h);
+                    }
+                }
+                pointer = {};
+            }
+        }
+
+        ~SharedMT() {
+            Reset();
+        }
+
+        template<typename U = T, typename...Args>
+        SharedMT<U>& Emplace(Args &&...args) {
+            static_assert(std::is_base_of_v<T, U> || std::is_same_v<T, U>);
+            static_assert(PtrAlignCheck_v<T, U>);
+            using HT = typename SharedMT<U>::HeaderType;
+            Reset();
+            auto h = PtrAlloc<HT>();
+            h->Init();
+            if constexpr (!std::has_virtual_destructor_v<T>) {
+                h->deleter = &PtrDelete<U>;
+            } else {
+                h->deleter = {};
+            }
+            std::construct_at(&h->data, std::forward<Args>(args)...);
+#ifdef XX_PTR_CENSUS
+            PtrCensusAlloc<U>();
+#endif
+            pointer = (T*)&h->data;
+            if constexpr (HasMemberType_cParentTypeId<T>) {
+                pointer->typeId = T::cTypeId;
+            }
+            return (SharedMT<U>&)*this;
+        }
+
+        WeakMT<T> ToWeak() const;
+    };
+
+    /************************************************************************************/
+
+    template<typename T>
+    struct WeakMT {
+        using HeaderType = PtrHeaderMT<T>;
+        using ElementType = T;
+        HeaderType* h{};
+
+        WeakMT() = default;
+
+        template<typename U>
+        WeakMT(SharedMT<U> const& s) {
+            static_assert(std::is_base_of_v<T, U> || std::is_same_v<T, U>);
+            static_assert(PtrAlignCheck_v<T, U>);
+            if (s.pointer) {
+                h = (HeaderType*)s.GetHeader();
+                h->weakCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        WeakMT(WeakMT const& o) : h(o.h) {
+            if (h) {
+                h->weakCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        WeakMT(WeakMT&& o) noexcept : h(std::exchange(o.h, nullptr)) {}
+
+        WeakMT& operator=(WeakMT const& o) {
+            WeakMT(o).Swap(*this);
+            return *this;
+        }
+
+        WeakMT& operator=(WeakMT&& o) noexcept {
+            std::swap(h, o.h);
+            return *this;
+        }
+
+        template<typename U>
+        WeakMT& operator=(SharedMT<U> const& s) {
+            WeakMT(s).Swap(*this);
+            return *this;
+        }
+
+        XX_INLINE void Swap(WeakMT& o) noexcept {
+            std::swap(h, o.h);
+        }
+
+        ~WeakMT() {
+            Reset();
+        }
+
+        // 仅供参考: 返回后 对象 可能 已被其他线程 释放. 需要访问 请用 Lock
+        operator bool() const {
+            return h && h->sharedCount.load(std::memory_order_relaxed);
+        }
+
+        uint32_t GetSharedCount() const {
+            if (!h) return 0;
+            return h->sharedCount.load(std::memory_order_relaxed);
+        }
+
+        void Reset() {
+            if (h) {
+                if (h->weakCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    PtrFree(h);
+                }
+                h = {};
+            }
+        }
+
+        // 对象 还活着 则 增加 sharedCount 并返回( 不会 复活 已归 0 的对象 )
+        SharedMT<T> Lock() const {
+            SharedMT<T> r;
+            if (h) {
+                auto n = h->sharedCount.load(std::memory_order_relaxed);
+                while (n) {
+                    if (h->sharedCount.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                        r.pointer = &h->data;
+                        break;
+                    }
+                }
+            }
+            return r;
+        }
+
+        template<typename U>
+        bool operator==(WeakMT<U> const& o) const {
+            return h == o.h;
+        }
+
+        template<typename U>
+        bool operator!=(WeakMT<U> const& o) const {
+            return h != o.h;
+        }
+    };
+
+    template<typename T>
+    WeakMT<T> SharedMT<T>::ToWeak() const {
+        return WeakMT<T>(*this);
+    }
+
+    /************************************************************************************/
+
+    // memmove support flags
+    template<typename T> struct IsPod<SharedMT<T>, void> : std::true_type {};
+    template<typename T> struct IsPod<WeakMT<T>, void> : std::true_type {};
+
+    template<typename T, typename...Args>
+    SharedMT<T> MakeSharedMT(Args &&...args) {
+        SharedMT<T> rtv;
+        rtv.template Emplace<T>(std::forward<Args>(args)...);
+        return rtv;
+    }
+}
+
+namespace std {
+    template<typename T>
+    struct hash<xx::SharedMT<T>> {
+        size_t operator()(xx::SharedMT<T> const& v) const {
+            return (size_t)v.pointer;
+        }
+    };
+
+    template<typename T>
+    struct hash<xx::WeakMT<T>> {
+        size_t operator()(xx::WeakMT<T> const& v) const {
+            return (size_t)v.h;
+        }
+    };
+}
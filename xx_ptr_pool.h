@@ -0,0 +1,141 @@
+﻿#pragma once
+#include "xx_typetraits.h"
+
+namespace xx {
+
+    // Shared / Weak 的 PtrHeader 内存池( slab ): 按 16 字节 分级, 每级 从 64K 的 chunk 中 顺序切块, 释放后 进入 thread_local 空闲链表
+    // 需定义 XX_PTR_USE_POOL 才会被 Shared / Weak 使用( 否则依旧 new / delete )
+    // 每块前面有 hLen ( max(16, align) ) 字节隐藏头, 末 2 字节 记录 hLen 与 分级, 故 Free 只需指针( 释放时 可能只知道 基类 header, 不知 长度 )
+    // 超过 1024 字节 的 与 线程退出后 分配的 直接 new ( 分级 记为 bigFlag ), 只多 hLen 字节
+    // 块 的 释放时机 不变: 对象析构后 若还有 Weak, 块 保留到 weakCount 归 0
+    // chunk 永不归还系统( 块 可能被 其他线程 持有 ). 跨线程 Free 也安全: 块 进入 释放线程 的 空闲链表
+    struct PtrPool {
+        static constexpr size_t chunkSize = 64 * 1024;
+        static constexpr size_t maxAlign = 64;                          // 支持的最大对齐( chunk 亦按此对齐 )
+        static constexpr size_t step = 16;
+        static constexpr size_t numClasses = 64;                        // 含 隐藏头 16 ~ 1024 字节, 更大的 单独分配
+        static constexpr uint8_t bigFlag = 0xFF;
+
+        struct Node {
+            Node* next;
+        };
+
+        struct Counters {
+            size_t allocs{}, hits{}, frees{}, bigs{}, chunks{};
+            std::array<int64_t, numClasses> lives{};                    // 各级 存活块数( 本线程 分配数 - 本线程 释放数, 跨线程释放 时 可能为负 )
+
+            int64_t GetLiveCount() const {
+                int64_t r{};
+                for (auto& n : lives) r += n;
+                return r;
+            }
+
+            int64_t GetLiveBytes() const {
+                int64_t r{};
+                for (size_t i = 0; i < numClasses; ++i) r += lives[i] * int64_t((i + 1) * step);
+                return r;
+            }
+
+            size_t GetChunkBytes() const {
+                return chunks * chunkSize;
+            }
+
+            // slab 利用率: 存活块 字节数 / chunk 总字节数
+            double GetUtilization() const {
+                return chunks ? double(GetLiveBytes()) / double(GetChunkBytes()) : 0;
+            }
+        };
+
+        struct ThreadCache {
+            std::array<Node*, numClasses> heads{};                      // 存的是 块首( 隐藏头 处 )
+            std::array<uint8_t*, numClasses> curs{}, ends{};            // 各级 当前 chunk 的 未切分区域
+            Counters counters;
+
+            ~ThreadCache() {
+                dead = true;
+            }
+        };
+
+        // 线程退出后 ThreadCache 已析构, 之后的 Alloc 走 单独分配, 池块 的 Free 直接丢弃
+        inline static thread_local bool dead{};
+
+        XX_INLINE static ThreadCache& TC() {
+            thread_local ThreadCache tc;
+            return tc;
+        }
+
+        // 在 块首 b 后 写 隐藏头, 返回 用户指针
+        XX_INLINE static void* SetTag(uint8_t* b, size_t hLen, uint8_t idx) {
+            auto p = b + hLen;
+            p[-2] = (uint8_t)hLen;
+            p[-1] = idx;
+            return p;
+        }
+
+        XX_INLINE static void* AllocBig(size_t siz, size_t hLen) {
+            uint8_t* b;
+            if (hLen > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                b = (uint8_t*)::operator new(hLen + siz, std::align_val_t(hLen));
+            } else {
+                b = (uint8_t*)::operator new(hLen + siz);
+            }
+            if (!dead) ++TC().counters.bigs;
+            return SetTag(b, hLen, bigFlag);
+        }
+
+        // 分配至少 siz 字节, 按 align 对齐( <= maxAlign ). 返回的指针 需用 Free 释放
+        XX_INLINE static void* Alloc(size_t siz, size_t align) {
+            assert(align <= maxAlign && std::has_single_bit(align));
+            auto hLen = align > step ? align : step;
+            auto total = (hLen + siz + hLen - 1) & ~(hLen - 1);         // 块长 为 hLen 的倍数, 则 chunk 中 所有块 都对齐
+            auto idx = total / step - 1;
+            if (idx >= numClasses || dead) return AllocBig(siz, hLen);
+            auto& tc = TC();
+            ++tc.counters.allocs;
+            ++tc.counters.lives[idx];
+            if (auto n = tc.heads[idx]) {
+                tc.heads[idx] = n->next;
+                ++tc.counters.hits;
+                return SetTag((uint8_t*)n, hLen, (uint8_t)idx);       // 同级 的 块长 相同, 块首 对齐 也 相同
+            }
+            auto bsiz = (idx + 1) * step;
+            if (size_t(tc.ends[idx] - tc.curs[idx]) < bsiz) {
+                auto c = (uint8_t*)::operator new(chunkSize, std::align_val_t(maxAlign));
+                tc.curs[idx] = c;
+                tc.ends[idx] = c + chunkSize;
+                ++tc.counters.chunks;
+            }
+            auto b = tc.curs[idx];
+            tc.curs[idx] += bsiz;
+            return SetTag(b, hLen, (uint8_t)idx);
+        }
+
+        XX_INLINE static void Free(void* ptr) {
+            auto p = (uint8_t*)ptr;
+            auto hLen = (size_t)p[-2];
+            auto idx = p[-1];
+            auto b = p - hLen;
+            if (idx == bigFlag) {
+                if (hLen > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                    ::operator delete(b, std::align_val_t(hLen));
+                } else {
+                    ::operator delete(b);
+                }
+                return;
+            }
+            if (dead) return;
+            auto& tc = TC();
+            ++tc.counters.frees;
+            --tc.counters.lives[idx];
+            auto n = (Node*)b;
+            n->next = tc.heads[idx];
+            tc.heads[idx] = n;
+        }
+
+        // 当前线程的计数
+        static Counters const& GetCounters() {
+            return TC().counters;
+        }
+    };
+
+}
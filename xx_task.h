@@ -1,7 +1,10 @@
 ﻿#pragma once
 #include "xx_time.h"
 #include "xx_blocklink.h"
-#include "xx_ptr.h"
+#include "xx_timer_wheel.h"
+#include "xx_task_pool.h"
+#include "xx_task_profile.h"
+#include "xx_ptr_mt.h"
 
 namespace xx {
     struct YieldType {
@@ -17,12 +20,24 @@ namespace xx {
     template<typename R = void>
     struct Task;
 
+    struct WorkerWait;
+
     namespace detail {
         template<typename Derived, typename R>
         struct PromiseBase {
             std::coroutine_handle<> prev, last;
             PromiseBase *root{ this };
             YieldType y;
+            double sleepUntil{};                // SleepFor 设置( root 上 ) 的 到期时间( steady epoch 秒 ), Run 到期后 清 0
+            WorkerWait* worker{};               // RunOnWorker 设置( root 上 ), Tasks 读取后 清 0
+#ifdef XX_TASK_PROFILE
+            TaskProfiler::Tag tag;              // Resume 耗时 统计 标签
+#endif
+
+#ifdef XX_TASK_USE_POOL
+            static void* operator new(size_t siz) { return TaskFramePool::Alloc(siz); }
+            static void operator delete(void* p, size_t siz) noexcept { TaskFramePool::Free(p, siz); }
+#endif
 
             struct FinalAwaiter {
                 bool await_ready() const noexcept { return false; }
@@ -108,6 +123,10 @@ namespace xx {
         template<bool runOnce = false>
         XX_INLINE void Run() {
             auto& p = coro.promise();
+            if (p.sleepUntil != 0) {            // SleepFor 未到期 则 不 resume ( Tasks 中 由 时间轮 唤醒, 其他 容器 / 手动 驱动 时 即 轮询 )
+                if (NowSteadyEpochSeconds() < p.sleepUntil) return;
+                p.sleepUntil = 0;
+            }
             auto& c = p.last;
             while(c && !c.done()) {
                 c.resume();
@@ -120,17 +139,148 @@ namespace xx {
         bool operator()() { Run<true>();return coro.done(); }
         void RunAll() { Run<true>(); }
         bool HasValue() const { return coro; }
+
+        // Resume 耗时 统计 标签( 需为 常量字符串 ). 未定义 XX_TASK_PROFILE 时 无效果
+        // tasks.Add( F().SetTag("name") );
+        Task& SetTag(char const* name) & {
+#ifdef XX_TASK_PROFILE
+            coro.promise().tag = { name, 0 };
+#endif
+            return *this;
+        }
+        Task&& SetTag(char const* name) && {
+            return std::move(SetTag(name));
+        }
     };
 
     template<typename R>
     struct IsPod<Task<R>> : std::true_type {};
 
+    // co_await xx::SleepFor(secs): 挂起 secs 秒. 到期时间 记在 root 上, 到期前 Task::Run 不 resume
+    // Tasks 中 期间 移出 链表 由 时间轮 唤醒; 其他 容器 / 手动 驱动 时 每帧 检查 时间( 依旧 不早于 到期 )
+    struct SleepFor {
+        double secs;
+        explicit SleepFor(double secs) : secs(secs) {}
+        bool await_ready() const noexcept { return secs <= 0; }
+        template<typename P>
+        void await_suspend(std::coroutine_handle<P> h) const noexcept {
+            auto root = h.promise().root;
+            root->y = {};                       // 清掉 之前 co_yield 的 值( 否则 EventTasks 会当作 继续等 该 key )
+            root->sleepUntil = NowSteadyEpochSeconds() + secs;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    /*************************************************************************************************************************/
+    /*************************************************************************************************************************/
+
+    // RunOnWorker 完成后 由 工作线程 投递 待唤醒 task 的 句柄, Tasks 下一帧 取走
+    struct TasksMailbox {
+        std::mutex mtx;
+        Listi32<BlockLinkVI> vis;
+        std::atomic<int32_t> count{};
+
+        void Push(BlockLinkVI const& vi) {
+            std::scoped_lock<std::mutex> g(mtx);
+            vis.Emplace(vi);
+            count.store(vis.len, std::memory_order_release);
+        }
+    };
+
+    // RunOnWorker 的 共享状态( 工作线程 与 协程 各持有 一份 引用, 协程 被删 也安全 )
+    struct WorkerWait {
+        static constexpr int32_t running = 0, done = 1, parked = 2;
+        std::atomic<int32_t> state{ running };
+        SharedMT<TasksMailbox> mailbox;
+        BlockLinkVI vi;
+
+        // 工作线程: 完成. 若 task 已被 Tasks 挂起 则 通知 唤醒
+        void Done() {
+            if (state.exchange(done, std::memory_order_acq_rel) == parked) {
+                mailbox->Push(vi);
+            }
+        }
+
+        // Tasks: 挂起 task. 返回 false: 已完成, 不必挂起
+        bool Park(SharedMT<TasksMailbox> const& mb, BlockLinkVI const& vi_) {
+            mailbox = mb;
+            vi = vi_;
+            auto s = running;
+            return state.compare_exchange_strong(s, parked, std::memory_order_acq_rel);
+        }
+
+        bool IsDone() const {
+            return state.load(std::memory_order_acquire) == done;
+        }
+    };
+
+    namespace detail {
+        template<typename R>
+        struct WorkerResult : WorkerWait {
+            std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> r;
+            std::exception_ptr ep;
+        };
+
+        struct WorkerAwaiter {
+            WorkerWait* w;
+            WorkerWait** rootWorker{};
+            bool await_ready() const noexcept { return w->IsDone(); }
+            template<typename P>
+            void await_suspend(std::coroutine_handle<P> h) noexcept {
+                auto root = h.promise().root;
+                root->y = {};                   // 清掉 之前 co_yield 的 值( 否则 EventTasks 会当作 继续等 该 key )
+                root->worker = w;
+                rootWorker = &root->worker;
+            }
+            void await_resume() const noexcept {
+                if (rootWorker) {
+                    *rootWorker = nullptr;      // 不在 Tasks 中 时 没人 清, 而 w 随 RunOnWorker 结束 释放
+                }
+            }
+        };
+    }
+
+    // 在 工作线程 执行 f ( 不可 访问 游戏线程 的 数据 ), 完成后 回到 调用者 所在 线程 继续, 返回 f 的 结果
+    // 在 Tasks 中 时 等待期间 不被 resume ( 完成时 由 工作线程 通知 ), 其他 容器 中 每次 resume 检查 一次
+    // f 抛出的 异常 带回 调用者 线程 重新抛出. f 需 可复制( std::function )
+    // example:
+    //      auto d = co_await xx::RunOnWorker([path] { return LoadAndDecode(path); });
+    template<typename F, typename R = std::invoke_result_t<F>>
+    Task<R> RunOnWorker(F f, Workers& ws = Workers::Instance()) {
+        auto s = MakeSharedMT<detail::WorkerResult<R>>();
+        ws.Post([s, f = std::move(f)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    f();
+                    s->r.emplace(true);
+                } else {
+                    s->r.emplace(f());
+                }
+            } catch (...) {
+                s->ep = std::current_exception();
+            }
+            s->Done();
+        });
+        while (!s->IsDone()) {
+            co_await detail::WorkerAwaiter{ s.pointer };
+        }
+        if (s->ep) {
+            std::rethrow_exception(s->ep);
+        }
+        if constexpr (!std::is_void_v<R>) {
+            co_return std::move(*s->r);
+        }
+    }
+
     /*************************************************************************************************************************/
     /*************************************************************************************************************************/
 
     struct Tasks {
         BlockLink<xx::Task<>, BlockLinkVINPT> tasks;
-        void Clear() { tasks.Clear(); }
+        TimerWheel<BlockLinkVI> sleeps;             // SleepFor 中的 task ( 已从 tasks 的 链表 Detach, 到期 Attach 回去 )
+        Listi32<BlockLinkVI> parkings, wakes;       // 本次 resume 后 要 sleep / 等 RunOnWorker 的; 取自 mailbox 的
+        SharedMT<TasksMailbox> mailbox;             // RunOnWorker 完成 通知
+        void Clear() { tasks.Clear(); sleeps.Clear(); }
         int32_t Count() const { return tasks.Count(); }
         bool Empty() const { return !tasks.Count(); }
         void Reserve(int32_t cap) { tasks.Reserve(cap); }
@@ -144,10 +294,21 @@ namespace xx {
         }
 
         // T: Task<> or callable
+        // XX_TASK_PROFILE: 未 SetTag 的 以 调用处 文件:行 为 标签
         template<typename T>
-        BlockLinkVI Add(T &&t) {
+        BlockLinkVI Add(T &&t
+#ifdef XX_TASK_PROFILE
+            , std::source_location const& loc = std::source_location::current()
+#endif
+        ) {
             if constexpr (std::is_convertible_v<Task<>, T>) {           // ([](...)->xx::Task<>{})(...)         // warning: can't capture in []
                 if (t) return {};
+                t.coro.promise().worker = nullptr;      // sleepUntil 保留: 未到期的 SleepFor 加入后 继续 睡
+#ifdef XX_TASK_PROFILE
+                if (auto& tag = t.coro.promise().tag; !tag.name) {
+                    tag = { loc.file_name(), (uint32_t)loc.line() };
+                }
+#endif
                 return (BlockLinkVI)tasks.EmplaceNode(std::forward<T>(t));
             } else {
                 return Add([](T t) -> Task<> {
@@ -157,17 +318,81 @@ namespace xx {
                         t();                                            // [...](){}
                         co_return;
                     }
-                }(std::forward<T>(t)));
+                }(std::forward<T>(t))
+#ifdef XX_TASK_PROFILE
+                    , loc
+#endif
+                );
             }
         }
 
-        // resume once
+        // resume once ( sleep / 等 RunOnWorker 中的 除外 )
         int32_t operator()() {
+            if (!sleeps.Empty()) {
+                Wake(NowSteadyEpochSeconds());
+            }
+            if (mailbox && mailbox->count.load(std::memory_order_acquire)) {
+                {
+                    std::scoped_lock<std::mutex> g(mailbox->mtx);
+                    std::swap(mailbox->vis, wakes);
+                    mailbox->count.store(0, std::memory_order_relaxed);
+                }
+                for (auto& vi : wakes) {
+                    if (auto n = tasks.TryGet(vi)) {
+                        tasks.Attach(*n);
+                    }
+                }
+                wakes.Clear();
+            }
             tasks.ForeachLink([&](xx::Task<>& o)->ForeachResult {
-                return o() ? ForeachResult::RemoveAndContinue : ForeachResult::Continue;
+#ifdef XX_TASK_PROFILE
+                auto t = std::chrono::steady_clock::now();
+                auto done = o();
+                TaskProfiler::OnResume(o.coro.promise().tag, std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count());
+                if (done) return ForeachResult::RemoveAndContinue;
+#else
+                if (o()) return ForeachResult::RemoveAndContinue;
+#endif
+                if (auto& p = o.coro.promise(); p.sleepUntil != 0 || p.worker) {
+                    auto n = container_of(&o, BlockLinkVINPT<xx::Task<>>, value);
+                    parkings.Emplace(BlockLinkVI{ n->version, n->index });
+                }
+                return ForeachResult::Continue;
             });
+            if (parkings.len) {
+                Park();
+            }
             return tasks.Count();
         }
+
+    protected:
+        void Park() {
+            for (auto& vi : parkings) {
+                auto n = tasks.TryGet(vi);
+                if (!n) continue;                       // 可能 被 之后 resume 的 task 删除
+                auto& p = n->value.coro.promise();
+                if (auto w = std::exchange(p.worker, nullptr)) {
+                    if (!mailbox) {
+                        mailbox.Emplace();
+                    }
+                    if (w->Park(mailbox, vi)) {
+                        tasks.Detach(*n);
+                    }
+                } else {
+                    sleeps.AddAt(p.sleepUntil, vi);     // 绝对时间: 时间轮 的 cur 可能 落后 最多 1 帧. 到期 由 Run 清
+                    tasks.Detach(*n);
+                }
+            }
+            parkings.Clear();
+        }
+
+        void Wake(double nowSecs) {
+            sleeps.Update(nowSecs, [this](BlockLinkVI& vi) {
+                if (auto n = tasks.TryGet(vi)) {        // 可能 已被 TaskGuard 等 删除
+                    tasks.Attach(*n);
+                }
+            });
+        }
     };
 
     /*************************************************************************************************************************/
@@ -205,10 +430,18 @@ namespace xx {
         }
 
         template<typename T>
-        void operator()(Tasks& tasks, T &&t) {
+        void operator()(Tasks& tasks, T &&t
+#ifdef XX_TASK_PROFILE
+            , std::source_location const& loc = std::source_location::current()
+#endif
+        ) {
             Clear();
             ptr = &tasks;
-            vi = tasks.Add(std::forward<T>(t));
+            vi = tasks.Add(std::forward<T>(t)
+#ifdef XX_TASK_PROFILE
+                , loc
+#endif
+            );
         }
 
         operator bool() const {
@@ -290,11 +523,37 @@ namespace xx {
     /*************************************************************************************************************************/
     /*************************************************************************************************************************/
 
-    template<int timeoutSecs = 15>
+    // 超时 由 时间轮 管理, 每次 operator() 只碰 到期的
+    // indexed: 按 key 建 哈希索引, 分发 O(1) ( 等待者 多 时 用 ). 同 key 多个 等待 时 取 最近 开始等待的
+    template<int timeoutSecs = 15, bool indexed = false>
     struct EventTasks {
-        using Tuple = std::tuple<ptrdiff_t, void*, double, Task<>>;
+        using Tuple = std::tuple<ptrdiff_t, void*, BlockLinkVI, Task<>>;       // key, arg, 超时 句柄( timeouts ), task
+        using NodeType = BlockLinkVINPT<Tuple>;
         Listi32<Task<>> tasks;
-        Listi32<Tuple> eventTasks;
+        BlockLink<Tuple, BlockLinkVINPT> eventTasks;
+        TimerWheel<BlockLinkVI> timeouts;                                       // value: eventTasks 的 句柄
+
+        // indexed 专用: key -> 最近的 节点下标. 同 key 的 节点 以 keyLinks ( 按 节点下标 ) 串成 双链表
+        struct KeyLink {
+            int32_t newer, older, version;
+        };
+        std::unordered_map<ptrdiff_t, int32_t> keys;
+        Listi32<KeyLink> keyLinks;
+
+        // 是否 有 task 在等 v
+        bool Exists(ptrdiff_t v) {
+            if constexpr (indexed) {
+                return keys.contains(v);
+            } else {
+                bool r{};
+                eventTasks.ForeachLink([&](Tuple& t)->ForeachResult {
+                    if (v != std::get<0>(t)) return ForeachResult::Continue;
+                    r = true;
+                    return ForeachResult::Break;
+                });
+                return r;
+            }
+        }
 
         template<typename T>
         void Add(T&& t) {
@@ -314,28 +573,43 @@ namespace xx {
         // return 0: miss or success
         template<typename Handler>
         ptrdiff_t operator()(ptrdiff_t v, Handler&& h) {
-            for (int i = eventTasks.len - 1; i >= 0; --i) {
-                auto& t = eventTasks[i];
-                if (v == std::get<0>(t)) {
-                    h(std::get<1>(t));
-                    return Resume(i, t);
+            ptrdiff_t r{};
+            if constexpr (indexed) {
+                auto it = keys.find(v);
+                if (it == keys.end()) return 0;
+                auto i = it->second;
+                auto n = eventTasks.TryGet(BlockLinkVI{ keyLinks[i].version, i });
+                assert(n);
+                h(std::get<1>(n->value));
+                if (Resume(n->value, r)) {
+                    eventTasks.Remove(n->value);
                 }
+            } else {
+                eventTasks.template ForeachLink<false>([&](Tuple& t)->ForeachResult {
+                    if (v != std::get<0>(t)) return ForeachResult::Continue;
+                    h(std::get<1>(t));
+                    return Resume(t, r) ? ForeachResult::RemoveAndBreak : ForeachResult::Break;
+                });
             }
-            return 0;
+            return r;
         }
 
         // handle eventTasks timeout & resume tasks
         // return 0: success
         ptrdiff_t operator()() {
-            if (!eventTasks.Empty()) {
-                auto now = NowSteadyEpochSeconds();
-                for (int i = eventTasks.len - 1; i >= 0; --i) {
-                    auto& t = eventTasks[i];
-                    if (std::get<2>(t) < now) {
-                        if (auto r = Resume(i, t)) return r;
-                    }
+            ptrdiff_t r{};
+            timeouts.Update(NowSteadyEpochSeconds(), [&](BlockLinkVI& vi) {
+                auto n = eventTasks.TryGet(vi);
+                if (!n) return;
+                auto& t = n->value;
+                std::get<2>(t) = {};                                            // 到期 即 已从 timeouts 移除
+                if (r) {
+                    std::get<2>(t) = timeouts.Add(0, vi);                       // 已出错: 留到 下次
+                } else if (Resume(t, r)) {
+                    eventTasks.Remove(t);
                 }
-            }
+            });
+            if (r) return r;
             if (!tasks.Empty()) {
                 for (int i = tasks.len - 1; i >= 0; --i) {
                     if (auto& t = tasks[i]; t()) {
@@ -343,7 +617,11 @@ namespace xx {
                     } else {
                         auto& y = t.coro.promise().y;
                         if (y.p) {
-                            eventTasks.Emplace(Tuple{ y.v, y.p, NowSteadyEpochSeconds() + timeoutSecs, std::move(t) });
+                            auto& n = eventTasks.EmplaceNode(y.v, y.p, BlockLinkVI{}, std::move(t));
+                            std::get<2>(n.value) = timeouts.AddAt(NowSteadyEpochSeconds() + timeoutSecs, BlockLinkVI{ n.version, n.index });
+                            if constexpr (indexed) {
+                                LinkKey(n);
+                            }
                             tasks.SwapRemoveAt(i);
                         } else {
                             if (y.v) return y.v;
@@ -355,27 +633,80 @@ namespace xx {
         }
 
         operator bool() const {
-            return eventTasks.len || tasks.len;
+            return eventTasks.Count() || tasks.len;
         }
 
     protected:
-        XX_INLINE ptrdiff_t Resume(int i, Tuple& tuple) {
+        void LinkKey(NodeType& n) {
+            if (keyLinks.len < eventTasks.len) {
+                keyLinks.Resize(eventTasks.len);
+            }
+            auto& kl = keyLinks[n.index];
+            kl.version = n.version;
+            kl.newer = -1;
+            auto [it, inserted] = keys.try_emplace(std::get<0>(n.value), n.index);
+            if (inserted) {
+                kl.older = -1;
+            } else {
+                kl.older = it->second;
+                keyLinks[it->second].newer = n.index;
+                it->second = n.index;
+            }
+        }
+
+        void UnlinkKey(NodeType& n) {
+            auto& kl = keyLinks[n.index];
+            if (kl.newer >= 0) {
+                keyLinks[kl.newer].older = kl.older;
+            } else if (kl.older >= 0) {
+                keys[std::get<0>(n.value)] = kl.older;
+            } else {
+                keys.erase(std::get<0>(n.value));
+            }
+            if (kl.older >= 0) {
+                keyLinks[kl.older].newer = kl.newer;
+            }
+        }
+
+        // return true: 需从 eventTasks 删除
+        XX_INLINE bool Resume(Tuple& tuple, ptrdiff_t& r) {
             auto& task = std::get<3>(tuple);
             if (task()) {
-                eventTasks.SwapRemoveAt(i);  // done
-            } else {
-                auto& y = task.coro.promise().y;
-                if (y.p) {           // renew
-                    std::get<0>(tuple) = y.v;
-                    std::get<1>(tuple) = y.p;
-                    std::get<2>(tuple) = NowSteadyEpochSeconds() + timeoutSecs;
-                } else {
-                    if (y.v) return y.v;   // yield error number ( != 0 )
-                    tasks.Emplace(std::move(task));      // yield 0
-                    eventTasks.SwapRemoveAt(i);
+                timeouts.Remove(std::get<2>(tuple));
+                if constexpr (indexed) {
+                    UnlinkKey(*container_of(&tuple, NodeType, value));
                 }
+                return true;    // done
             }
-            return 0;
+            auto& y = task.coro.promise().y;
+            if (y.p) {           // renew
+                auto n = container_of(&tuple, NodeType, value);
+                if constexpr (indexed) {
+                    UnlinkKey(*n);
+                }
+                std::get<0>(tuple) = y.v;
+                std::get<1>(tuple) = y.p;
+                if constexpr (indexed) {
+                    LinkKey(*n);
+                }
+                timeouts.Remove(std::get<2>(tuple));
+                std::get<2>(tuple) = timeouts.AddAt(NowSteadyEpochSeconds() + timeoutSecs, BlockLinkVI{ n->version, n->index });    // 可能 来自 分发, 时间轮 未必 刚 Update
+                return false;
+            }
+            if (y.v) {          // yield error number ( != 0 ). 保持 原超时
+                r = y.v;
+                if (!timeouts.TryGet(std::get<2>(tuple))) {
+                    auto n = container_of(&tuple, NodeType, value);
+                    std::get<2>(tuple) = timeouts.Add(0, BlockLinkVI{ n->version, n->index });
+                }
+                return false;
+            }
+            timeouts.Remove(std::get<2>(tuple));
+            if constexpr (indexed) {
+                UnlinkKey(*container_of(&tuple, NodeType, value));
+            }
+            tasks.Emplace(std::move(task));      // yield 0
+            return true;
         }
     };
 }
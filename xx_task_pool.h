@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "xx_includes.h"
+
+namespace xx {
+
+    // Task 协程帧 内存池: 按 64 字节 分级( 最大 4K ), 释放后 进入 thread_local 空闲链表, 下次 同级 分配 直接复用. 更大的 直接 new / delete
+    // 需定义 XX_TASK_USE_POOL 才会被 Task 的 promise 使用. 每块 单独 ::operator new, 故 跨线程 释放 / 线程退出后 释放 都安全
+    // 协程帧 在 加入 Tasks 之前 就已分配, 无法 按 Tasks 分区, 故 只做 按线程 缓存
+    struct TaskFramePool {
+        static constexpr size_t step = 64;
+        static constexpr size_t numClasses = 64;
+
+        struct Node {
+            Node* next;
+        };
+
+        struct Counters {
+            int64_t allocs{}, hits{}, frees{}, bigs{};
+            int64_t frames{}, bytes{};                  // 本线程 在用 帧数 / 字节数( 跨线程释放 时 可能为负 )
+            int64_t cachedBytes{};                      // 空闲链表 中 的 字节数
+        };
+
+        struct ThreadCache {
+            std::array<Node*, numClasses> heads{};
+            Counters counters;
+
+            ~ThreadCache() {
+                for (size_t i = 0; i < numClasses; ++i) {
+                    for (auto n = heads[i]; n;) {
+                        auto next = n->next;
+                        ::operator delete(n);
+                        n = next;
+                    }
+                }
+                dead = true;
+            }
+        };
+
+        inline static thread_local bool dead{};
+
+        XX_INLINE static ThreadCache& TC() {
+            thread_local ThreadCache tc;
+            return tc;
+        }
+
+        XX_INLINE static void* Alloc(size_t siz) {
+            auto idx = (siz + step - 1) / step - 1;
+            if (idx >= numClasses) {
+                if (!dead) {
+                    auto& c = TC().counters;
+                    ++c.allocs;
+                    ++c.bigs;
+                    ++c.frames;
+                    c.bytes += siz;
+                }
+                return ::operator new(siz);
+            }
+            auto bsiz = (idx + 1) * step;                   // 总按 级长 分配( 可能 被 别的线程 缓存 复用 )
+            if (dead) return ::operator new(bsiz);
+            auto& tc = TC();
+            ++tc.counters.allocs;
+            ++tc.counters.frames;
+            tc.counters.bytes += siz;
+            if (auto n = tc.heads[idx]) {
+                tc.heads[idx] = n->next;
+                ++tc.counters.hits;
+                tc.counters.cachedBytes -= bsiz;
+                return n;
+            }
+            return ::operator new(bsiz);
+        }
+
+        // siz 必须 与 Alloc 时 相同( 协程帧 的 sized delete 保证 )
+        XX_INLINE static void Free(void* ptr, size_t siz) {
+            auto idx = (siz + step - 1) / step - 1;
+            if (dead) {
+                ::operator delete(ptr);
+                return;
+            }
+            auto& tc = TC();
+            ++tc.counters.frees;
+            --tc.counters.frames;
+            tc.counters.bytes -= siz;
+            if (idx >= numClasses) {
+                ::operator delete(ptr);
+                return;
+            }
+            tc.counters.cachedBytes += (idx + 1) * step;
+            auto n = (Node*)ptr;
+            n->next = tc.heads[idx];
+            tc.heads[idx] = n;
+        }
+
+        // 当前线程的计数
+        static Counters const& GetCounters() {
+            return TC().counters;
+        }
+    };
+
+}
@@ -0,0 +1,114 @@
+﻿#pragma once
+#include "xx_includes.h"
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+
+namespace xx {
+
+    // Tasks 中 每个 task 的 Resume 耗时 统计( 按 标签 ): 次数, 总耗时, 最大耗时, 以及 每帧 的 这三项. 用于 找出 导致 卡帧 的 协程
+    // 需定义 XX_TASK_PROFILE 才会 记录( 否则 标签 与 计时 代码 都不存在 ). 每线程 一份, 每帧 调用 NextFrame ( FpsViewer 会自动调用 )
+    // 标签: Tasks::Add 调用处 的 文件:行, 或 Task::SetTag 指定的 名字( 需为 常量字符串 )
+    struct TaskProfiler {
+        struct Tag {
+            char const* name{};                         // 名字 或 文件名
+            uint32_t line{};                            // 0: name 为 名字
+            bool operator==(Tag const& o) const { return name == o.name && line == o.line; }
+        };
+
+        struct TagHash {
+            size_t operator()(Tag const& t) const {
+                return std::hash<void const*>()(t.name) ^ (size_t(t.line) * 0x9E3779B97F4A7C15ull);
+            }
+        };
+
+        struct Entry {
+            std::string name;
+            int64_t count{};
+            double total{}, max{};                                  // 秒
+            int64_t frameCount{};                                   // 当前帧
+            double frameTotal{}, frameMax{};
+            int64_t lastFrameCount{};                               // 上一帧
+            double lastFrameTotal{}, lastFrameMax{};
+        };
+
+        std::unordered_map<Tag, Entry, TagHash> entries;
+        double frameTotal{}, lastFrameTotal{};
+
+        static TaskProfiler& Instance() {
+            thread_local TaskProfiler tp;
+            return tp;
+        }
+
+        static Entry& GetEntry(Tag const& t) {
+            auto& e = Instance().entries[t];
+            if (e.name.empty()) {
+                if (!t.name) {
+                    e.name = "(untagged)";
+                } else if (t.line) {
+                    std::string_view fn(t.name);
+                    if (auto i = fn.find_last_of("/\\"); i != fn.npos) {
+                        fn = fn.substr(i + 1);
+                    }
+                    e.name = std::string(fn) + ':' + std::to_string(t.line);
+                } else {
+                    e.name = t.name;
+                }
+            }
+            return e;
+        }
+
+        // 一次 Resume 结束 后 调用
+        static void OnResume(Tag const& t, double secs) {
+            auto& e = GetEntry(t);
+            ++e.count;
+            e.total += secs;
+            if (secs > e.max) e.max = secs;
+            ++e.frameCount;
+            e.frameTotal += secs;
+            if (secs > e.frameMax) e.frameMax = secs;
+            Instance().frameTotal += secs;
+        }
+
+        // 帧结束: 当前帧计数 转为 上一帧
+        static void NextFrame() {
+            auto& tp = Instance();
+            for (auto& [k, e] : tp.entries) {
+                e.lastFrameCount = std::exchange(e.frameCount, 0);
+                e.lastFrameTotal = std::exchange(e.frameTotal, 0);
+                e.lastFrameMax = std::exchange(e.frameMax, 0);
+            }
+            tp.lastFrameTotal = std::exchange(tp.frameTotal, 0);
+        }
+
+        // 上一帧 所有 Resume 总耗时( 秒 )
+        static double GetLastFrameTotal() {
+            return Instance().lastFrameTotal;
+        }
+
+        // 复制所有标签的统计 ( 按 上一帧 总耗时 降序, 其次 历史 最大耗时 )
+        static std::vector<Entry> GetEntries() {
+            std::vector<Entry> r;
+            for (auto& [k, e] : Instance().entries) r.push_back(e);
+            std::sort(r.begin(), r.end(), [](Entry const& a, Entry const& b) {
+                return a.lastFrameTotal > b.lastFrameTotal || (a.lastFrameTotal == b.lastFrameTotal && a.max > b.max);
+            });
+            return r;
+        }
+
+        // 文本报表( 每行一个标签, 最多 topN 行, 时间单位 微秒 )
+        static std::string Dump(size_t topN = 30) {
+            std::string s = "frame#\tframe\tframeMax\tcount\ttotal\tmax\ttag\n";
+            auto es = GetEntries();
+            for (size_t i = 0, e = std::min(topN, es.size()); i < e; ++i) {
+                auto& o = es[i];
+                s += std::to_string(o.lastFrameCount) + '\t' + std::to_string(int64_t(o.lastFrameTotal * 1000000))
+                    + '\t' + std::to_string(int64_t(o.lastFrameMax * 1000000)) + '\t' + std::to_string(o.count)
+                    + '\t' + std::to_string(int64_t(o.total * 1000000)) + '\t' + std::to_string(int64_t(o.max * 1000000))
+                    + '\t' + o.name + '\n';
+            }
+            return s;
+        }
+    };
+
+}
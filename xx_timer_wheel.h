@@ -0,0 +1,151 @@
+﻿#pragma once
+#include "xx_time.h"
+#include "xx_blocklink.h"
+
+namespace xx {
+
+	// 分层 时间轮: 4 层 * 256 槽, 每 tick 只处理 当前槽, 高层 的 槽 在 低层 转一圈 时 下放( cascade ). Add / Remove O(1), Update 只碰 到期的
+	// 时间 以 秒 表示( 默认 steady epoch ), 精度 tickSecs. 范围 2^32 tick ( 1ms 时 约 49 天 ), 更远的 按 最远 处理
+	// Remove 只释放 节点, 槽中 残留的 句柄 在 下放 / 到期 时 因 version 不符 跳过
+	// example:
+	//      xx::TimerWheel<int> tw;
+	//      auto vi = tw.Add(1.5, 123);
+	//      tw.Update(xx::NowSteadyEpochSeconds(), [](int& v) { ... });
+	template<typename T>
+	struct TimerWheel {
+		static constexpr int32_t numLevels = 4;
+		static constexpr int32_t slotBits = 8;
+		static constexpr int32_t numSlots = 1 << slotBits;
+		static constexpr int32_t slotMask = numSlots - 1;
+		static constexpr int64_t maxTicks = (int64_t(1) << (slotBits * numLevels)) - 1;
+
+		struct Item {
+			T value;
+			int64_t expire;
+		};
+
+		BlockLink<Item, BlockLinkVIT> items;
+		std::array<Listi32<BlockLinkVI>, numLevels * numSlots> slots;
+		Listi32<BlockLinkVI> tmp;
+		double tickSecs, baseSecs;
+		int64_t cur{};											// 已处理到的 tick
+
+		explicit TimerWheel(double tickSecs_ = 0.001, double nowSecs = NowSteadyEpochSeconds())
+			: tickSecs(tickSecs_), baseSecs(nowSecs) {
+			assert(tickSecs > 0);
+		}
+		TimerWheel(TimerWheel const&) = delete;
+		TimerWheel& operator=(TimerWheel const&) = delete;
+		TimerWheel(TimerWheel&&) noexcept = default;
+		TimerWheel& operator=(TimerWheel&&) noexcept = default;
+
+		XX_INLINE int32_t Count() const {
+			return items.Count();
+		}
+
+		XX_INLINE bool Empty() const {
+			return items.Empty();
+		}
+
+		// 当前 时间( 最后一次 Update 对齐到 tick )
+		XX_INLINE double GetNowSecs() const {
+			return baseSecs + double(cur) * tickSecs;
+		}
+
+		// delaySecs 秒后 到期( 相对于 最后一次 Update, 至少 1 tick ). 返回 句柄 用于 Remove
+		template<typename...Args>
+		BlockLinkVI Add(double delaySecs, Args&&... args) {
+			return AddTicks((int64_t)std::ceil(delaySecs / tickSecs), std::forward<Args>(args)...);
+		}
+
+		// 在 atSecs ( 与 Update 同一时间轴 ) 到期. 不依赖 最后一次 Update 的 时间
+		template<typename...Args>
+		BlockLinkVI AddAt(double atSecs, Args&&... args) {
+			return AddTicks((int64_t)std::ceil((atSecs - baseSecs) / tickSecs) - cur, std::forward<Args>(args)...);
+		}
+
+		bool Remove(BlockLinkVI const& vi) {
+			return items.Remove(vi);
+		}
+
+		T* TryGet(BlockLinkVI const& vi) const {
+			if (auto o = items.TryGet(vi)) return &o->value.value;
+			return nullptr;
+		}
+
+		template<bool freeBuf = false>
+		void Clear() {
+			items.template Clear<freeBuf>();
+			for (auto& s : slots) {
+				s.Clear(freeBuf);
+			}
+		}
+
+		// 推进到 nowSecs, 对 到期的 调用 f(T&) 后 删除. f 中 可 Add / Remove
+		template<typename F>
+		void Update(double nowSecs, F&& f) {
+			auto target = (int64_t)std::floor((nowSecs - baseSecs) / tickSecs);
+			if (target <= cur) return;
+			if (items.Empty()) {
+				cur = target;
+				return;
+			}
+			while (cur < target) {
+				++cur;
+				// 低层 转完一圈: 高层 当前槽 下放
+				for (int32_t lv = 1; lv < numLevels; ++lv) {
+					if ((cur >> (slotBits * (lv - 1))) & slotMask) break;
+					Cascade(lv * numSlots + int32_t((cur >> (slotBits * lv)) & slotMask));
+				}
+				auto& s = slots[cur & slotMask];
+				if (s.Empty()) continue;
+				std::swap(s, tmp);
+				for (auto& vi : tmp) {
+					if (auto o = items.TryGet(vi)) {
+						f(o->value.value);
+						items.Remove(vi);					// f 中 可能 已删
+					}
+				}
+				tmp.Clear();
+				if (items.Empty()) {
+					cur = target;
+					break;
+				}
+			}
+		}
+
+	protected:
+		template<typename...Args>
+		BlockLinkVI AddTicks(int64_t d, Args&&... args) {
+			if (d < 1) d = 1;
+			else if (d > maxTicks) d = maxTicks;
+			auto& o = items.EmplaceNode(Item{ T(std::forward<Args>(args)...), cur + d });
+			BlockLinkVI vi{ o.version, o.index };
+			Place(vi, o.value.expire);
+			return vi;
+		}
+
+		// 按 与 cur 的 距离 选 层. expire <= cur 放 当前槽 ( 下放时 正要处理 )
+		XX_INLINE void Place(BlockLinkVI const& vi, int64_t expire) {
+			auto d = expire - cur;
+			int32_t lv = 0;
+			while (lv < numLevels - 1 && d >= (int64_t(1) << (slotBits * (lv + 1)))) {
+				++lv;
+			}
+			slots[lv * numSlots + int32_t((expire >> (slotBits * lv)) & slotMask)].Emplace(vi);
+		}
+
+		void Cascade(int32_t slotIdx) {
+			auto& s = slots[slotIdx];
+			if (s.Empty()) return;
+			std::swap(s, tmp);
+			for (auto& vi : tmp) {
+				if (auto o = items.TryGet(vi)) {
+					Place(vi, o->value.expire);
+				}
+			}
+			tmp.Clear();
+		}
+	};
+
+}
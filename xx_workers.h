@@ -0,0 +1,114 @@
+﻿#pragma once
+#include "xx_includes.h"
+
+namespace xx {
+
+	// 定长 工作线程池. Post 投递任务; ParallelFor 把 [0, n) 分给 所有线程( 含 调用者 ) 并等待完成
+	struct Workers {
+		std::vector<std::thread> threads;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::deque<std::function<void()>> jobs;
+		bool stopping{};
+
+		// numThreads == 0: 核数 - 1 ( 调用者线程 也参与 ParallelFor )
+		explicit Workers(size_t numThreads = 0) {
+			if (!numThreads) {
+				auto n = std::thread::hardware_concurrency();
+				numThreads = n > 1 ? n - 1 : 1;
+			}
+			for (size_t i = 0; i < numThreads; ++i) {
+				threads.emplace_back([this] {
+					while (true) {
+						std::function<void()> job;
+						{
+							std::unique_lock<std::mutex> lk(mtx);
+							cv.wait(lk, [this] { return stopping || !jobs.empty(); });
+							if (jobs.empty()) return;
+							job = std::move(jobs.front());
+							jobs.pop_front();
+						}
+						job();
+					}
+				});
+			}
+		}
+		Workers(Workers const&) = delete;
+		Workers& operator=(Workers const&) = delete;
+
+		~Workers() {
+			{
+				std::scoped_lock<std::mutex> g(mtx);
+				stopping = true;
+			}
+			cv.notify_all();
+			for (auto& t : threads) {
+				t.join();
+			}
+		}
+
+		// 全局 共享 实例
+		static Workers& Instance() {
+			static Workers ws;
+			return ws;
+		}
+
+		XX_INLINE size_t GetNumThreads() const {
+			return threads.size();
+		}
+
+		void Post(std::function<void()>&& job) {
+			{
+				std::scoped_lock<std::mutex> g(mtx);
+				jobs.push_back(std::move(job));
+			}
+			cv.notify_one();
+		}
+
+		// f(int32_t i) 被 并发调用 n 次( i 各不相同 ), 全部 下标 完成 即 返回( 不等 尚未开始的 辅助任务, 它们 开始时 发现 无事可做 直接退出 )
+		// f 抛出的 首个 异常 在 调用者 线程 重新抛出( 其余 下标 跳过 ). 可 嵌套 调用( 无 空闲线程 时 调用者 自己 做完 )
+		template<typename F>
+		void ParallelFor(int32_t n, F&& f) {
+			if (n <= 0) return;
+			using FT = std::remove_reference_t<F>;
+			struct State {
+				std::atomic<int32_t> next{}, done{};		// 已领取 / 已完成 的 下标数
+				std::atomic<bool> failed{};
+				std::exception_ptr ep;
+				FT* f;
+				int32_t n;
+
+				// 领到 下标 的 才会 访问 f, 而 调用者 要等 所有 下标 完成 才返回, 故 f 此时 必然有效
+				void Loop() {
+					for (int32_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+						if (!failed.load(std::memory_order_relaxed)) {
+							try {
+								(*f)(i);
+							} catch (...) {
+								if (!failed.exchange(true, std::memory_order_relaxed)) {
+									ep = std::current_exception();
+								}
+							}
+						}
+						done.fetch_add(1, std::memory_order_release);
+					}
+				}
+			};
+			auto s = std::make_shared<State>();
+			s->f = &f;
+			s->n = n;
+			auto numHelpers = (int32_t)std::min(threads.size(), size_t(n - 1));
+			for (int32_t i = 0; i < numHelpers; ++i) {
+				Post([s] { s->Loop(); });
+			}
+			s->Loop();
+			while (s->done.load(std::memory_order_acquire) < n) {
+				std::this_thread::yield();
+			}
+			if (s->ep) {
+				std::rethrow_exception(s->ep);
+			}
+		}
+	};
+
+}
@@ -152,4 +152,12 @@ namespace xx {
 		}
 	};
 
+	template<typename T>
+	struct DataMaxSize<T, std::enable_if_t<IsXY_v<T>>>
+		: std::integral_constant<size_t, DataMaxSize_v<decltype(std::declval<T>().x)> * 2> {};
+
+	template<typename T>
+	struct DataRawLayout<T, std::enable_if_t<IsXY_v<T>>>
+		: std::integral_constant<bool, std::is_floating_point_v<decltype(std::declval<T>().x)>> {};
+
 }
@@ -1,14 +1,82 @@
 ﻿#pragma once
 #include <xx_data.h>
 #include <zstd.h>
+#include <zdict.h>
 
 namespace xx {
 
+    // 流式解压: 输入 可分多次 Feed ( 例如 边下载边解压 ), 输出 按块( <= ZSTD_DStreamOutSize ) 回调 f(Span const&). 不需要 帧内容长度
+    // 可复用: 一帧结束( IsDone ) 后 继续 Feed 下一帧. 出错 抛异常
+    struct ZstdDStream {
+        ZSTD_DCtx* ctx;
+        Data out;
+        size_t lastRet{};               // ZSTD_decompressStream 的返回值, 0 表示 刚好结束一帧
+
+        ZstdDStream() : ctx(ZSTD_createDCtx()) {
+            if (!ctx) throw std::logic_error("ZSTD_createDCtx error.");
+            out.Resize(ZSTD_DStreamOutSize());
+        }
+        ZstdDStream(ZstdDStream const&) = delete;
+        ZstdDStream& operator=(ZstdDStream const&) = delete;
+        ~ZstdDStream() {
+            ZSTD_freeDCtx(ctx);
+        }
+
+        template<typename F>
+        void Feed(std::string_view const& src, F&& f) {
+            ZSTD_inBuffer in{ src.data(), src.size(), 0 };
+            ZSTD_outBuffer o;
+            do {
+                o = { out.buf, out.len, 0 };
+                lastRet = ZSTD_decompressStream(ctx, &o, &in);
+                if (ZSTD_isError(lastRet)) throw std::logic_error(std::string("ZstdDStream decompress error: ") + ZSTD_getErrorName(lastRet));
+                if (o.pos) {
+                    f(Span(out.buf, o.pos));
+                }
+            } while (in.pos < in.size || (lastRet && o.pos == o.size));  // 输出满了 则内部可能还有数据( 返回 0 表示 帧已结束 且 已全部输出 )
+        }
+
+        // 已 Feed 的数据 是否 刚好是 完整的帧
+        XX_INLINE bool IsDone() const {
+            return lastRet == 0;
+        }
+
+        // 丢弃 未完成的帧, 重新开始
+        void Reset() {
+            ZSTD_DCtx_reset(ctx, ZSTD_reset_session_only);
+            lastRet = 0;
+        }
+    };
+
+    // 流式解压 整段数据, 追加到 dst ( 适用于 帧内容长度 未知 的情况 )
+    // 解压后 超过 maxSize 抛异常( dst 恢复原长 ). 输入 不可信 时 防 解压炸弹
+    inline void ZstdDecompressStream(std::string_view const& src, Data& dst, size_t maxSize = 64 * 1024 * 1024) {
+        auto base = dst.len;
+        ZstdDStream ds;
+        ds.Feed(src, [&](Span const& s) {
+            if (dst.len - base + s.len > maxSize) {
+                dst.len = base;
+                throw std::logic_error("ZstdDecompressStream error: content size > maxSize.");
+            }
+            dst.WriteBuf(s.buf, s.len);
+        });
+        if (!ds.IsDone()) {
+            dst.len = base;
+            throw std::logic_error("ZstdDecompressStream error: incomplete frame.");
+        }
+    }
+
     // .exe + 50k
-    inline void ZstdDecompress(std::string_view const& src, Data& dst) {
+    // 解压后 超过 maxSize ( 帧头 记录的 或 流式 实际的 ) 抛异常
+    inline void ZstdDecompress(std::string_view const& src, Data& dst, size_t maxSize = 64 * 1024 * 1024) {
         auto&& siz = ZSTD_getFrameContentSize(src.data(), src.size());
-        if (ZSTD_CONTENTSIZE_UNKNOWN == siz) throw std::logic_error("ZstdDecompress error: unknown content size.");
+        if (ZSTD_CONTENTSIZE_UNKNOWN == siz) {     // 流式压缩 产生的帧 可能没有 内容长度
+            dst.Clear();
+            ZstdDecompressStream(src, dst, maxSize);
+            return;
+        }
         if (ZSTD_CONTENTSIZE_ERROR == siz) throw std::logic_error("ZstdDecompress read content size error.");
+        if (siz > maxSize) throw std::logic_error("ZstdDecompress error: content size > maxSize.");
         dst.Resize(siz);
         if (0 == siz) return;
         siz = ZSTD_decompress(dst.buf, siz, src.data(), src.size());
@@ -16,11 +84,11 @@ namespace xx {
         dst.Resize(siz);
     }
 
-    inline void TryZstdDecompress(Data& d) {
+    inline void TryZstdDecompress(Data& d, size_t maxSize = 64 * 1024 * 1024) {
         if (d.len >= 4) {
             if (d[0] == 0x28 && d[1] == 0xB5 && d[2] == 0x2F && d[3] == 0xFD) {
                 Data d2;
-                ZstdDecompress(d, d2);
+                ZstdDecompress(d, d2, maxSize);
                 std::swap(d, d2);
             }
         }
@@ -37,4 +105,216 @@ namespace xx {
         }
     }
 
+    // 字典: 由 样本 训练( ZDICT_trainFromBuffer ) 或 载入 现成字典数据. 预先生成 CDict / DDict, 之后 压缩 / 解压 不再解析字典
+    // 适合 大量 100 ~ 500 字节 的 小包. 收发双方 需使用 同一份字典( 可先 Train, 再把 buf 存盘 / 下发, 另一端 Load )
+    struct ZstdDict {
+        Data buf;                       // 字典原始数据
+        ZSTD_CDict* cdict{};
+        ZSTD_DDict* ddict{};
+
+        ZstdDict() = default;
+        ZstdDict(ZstdDict const&) = delete;
+        ZstdDict& operator=(ZstdDict const&) = delete;
+        ZstdDict(ZstdDict&& o) noexcept
+            : buf(std::move(o.buf)), cdict(std::exchange(o.cdict, nullptr)), ddict(std::exchange(o.ddict, nullptr)) {
+        }
+        ZstdDict& operator=(ZstdDict&& o) noexcept {
+            std::swap(buf, o.buf);
+            std::swap(cdict, o.cdict);
+            std::swap(ddict, o.ddict);
+            return *this;
+        }
+        ~ZstdDict() {
+            Clear();
+        }
+
+        XX_INLINE operator bool() const {
+            return cdict != nullptr;
+        }
+
+        // 载入字典数据( level 为之后用该字典压缩的等级 )
+        void Load(std::string_view const& dict, int level = 3) {
+            Clear();
+            buf.WriteBuf(dict.data(), dict.size());
+            cdict = ZSTD_createCDict(buf.buf, buf.len, level);
+            ddict = ZSTD_createDDict(buf.buf, buf.len);
+            if (!cdict || !ddict) {
+                Clear();
+                throw std::logic_error("ZstdDict load error.");
+            }
+        }
+
+        // 用 样本 训练出字典 并载入. samples 为 元素含 buf + len 的容器( 例如 List<Data> ). 样本数 通常需 数百 以上
+        template<typename Samples>
+        void Train(Samples const& samples, size_t dictCap = 16 * 1024, int level = 3) {
+            Data all;
+            std::vector<size_t> sizes;
+            for (auto const& d : samples) {
+                all.WriteBuf(d.buf, d.len);
+                sizes.push_back(d.len);
+            }
+            Data d;
+            d.Resize(dictCap);
+            auto r = ZDICT_trainFromBuffer(d.buf, d.len, all.buf, sizes.data(), (unsigned)sizes.size());
+            if (ZDICT_isError(r)) throw std::logic_error(std::string("ZstdDict train error: ") + ZDICT_getErrorName(r));
+            Load({ (char*)d.buf, r }, level);
+        }
+
+        // 字典 id ( 0: 无效 )
+        unsigned GetId() const {
+            return buf.len ? ZDICT_getDictID(buf.buf, buf.len) : 0;
+        }
+
+        void Clear() {
+            if (cdict) {
+                ZSTD_freeCDict(cdict);
+                cdict = {};
+            }
+            if (ddict) {
+                ZSTD_freeDDict(ddict);
+                ddict = {};
+            }
+            buf.Clear(true);
+        }
+    };
+
+    // 可复用的 压缩上下文: 省去 ZSTD_compress 每次 分配 + 初始化 上下文 的开销. 非线程安全, 每线程 / 每连接 一个
+    // 压缩结果 追加写入 dst ( 方便先写 包头 )
+    struct ZstdCCtx {
+        ZSTD_CCtx* ctx;
+
+        ZstdCCtx() : ctx(ZSTD_createCCtx()) {
+            if (!ctx) throw std::logic_error("ZSTD_createCCtx error.");
+        }
+        ZstdCCtx(ZstdCCtx const&) = delete;
+        ZstdCCtx& operator=(ZstdCCtx const&) = delete;
+        ZstdCCtx(ZstdCCtx&& o) noexcept : ctx(std::exchange(o.ctx, nullptr)) {}
+        ZstdCCtx& operator=(ZstdCCtx&& o) noexcept {
+            std::swap(ctx, o.ctx);
+            return *this;
+        }
+        ~ZstdCCtx() {
+            if (ctx) {
+                ZSTD_freeCCtx(ctx);
+            }
+        }
+
+        template<int level = 3>
+        void Compress(std::string_view const& src, Data& dst) {
+            auto req = ZSTD_compressBound(src.size());
+            dst.Reserve(dst.len + req);
+            auto r = ZSTD_compressCCtx(ctx, dst.buf + dst.len, req, src.data(), src.size(), level);
+            if (ZSTD_isError(r)) throw std::logic_error("ZstdCCtx compress error.");
+            dst.len += r;
+        }
+
+        // 使用字典压缩( 等级 由 字典 Load 时指定 )
+        void Compress(std::string_view const& src, Data& dst, ZstdDict const& dict) {
+            assert(dict);
+            auto req = ZSTD_compressBound(src.size());
+            dst.Reserve(dst.len + req);
+            auto r = ZSTD_compress_usingCDict(ctx, dst.buf + dst.len, req, src.data(), src.size(), dict.cdict);
+            if (ZSTD_isError(r)) throw std::logic_error("ZstdCCtx compress using dict error.");
+            dst.len += r;
+        }
+    };
+
+    // 多线程压缩( 大文件 / 资源包 ). nbWorkers == 0 则使用 全部核心. 需 libzstd 以 ZSTD_MULTITHREAD 编译, 否则 退化为 单线程
+    template<int level = 3, bool doShrink = true>
+    inline void ZstdCompressMT(std::string_view const& src, Data& dst, int nbWorkers = 0) {
+        ZstdCCtx c;
+        if (!nbWorkers) {
+            nbWorkers = (int)std::thread::hardware_concurrency();
+        }
+        ZSTD_CCtx_setParameter(c.ctx, ZSTD_c_compressionLevel, level);
+        (void)ZSTD_CCtx_setParameter(c.ctx, ZSTD_c_nbWorkers, nbWorkers);   // 不支持多线程时 返回错误, 忽略
+        auto req = ZSTD_compressBound(src.size());
+        dst.Resize(req);
+        auto r = ZSTD_compress2(c.ctx, dst.buf, dst.cap, src.data(), src.size());
+        if (ZSTD_isError(r)) throw std::logic_error(std::string("ZstdCompressMT error: ") + ZSTD_getErrorName(r));
+        dst.len = r;
+        if (doShrink) {
+            dst.Shrink();
+        }
+    }
+
+    // 可复用的 解压上下文. 非线程安全. 解压结果 追加写入 dst
+    struct ZstdDCtx {
+        ZSTD_DCtx* ctx;
+        size_t maxSize;                 // 单帧 解压后 最大长度( 输入 不可信 时 防 伪造帧头 导致 超大分配 ), 超过 抛异常
+
+        explicit ZstdDCtx(size_t maxSize_ = 64 * 1024 * 1024) : ctx(ZSTD_createDCtx()), maxSize(maxSize_) {
+            if (!ctx) throw std::logic_error("ZSTD_createDCtx error.");
+        }
+        ZstdDCtx(ZstdDCtx const&) = delete;
+        ZstdDCtx& operator=(ZstdDCtx const&) = delete;
+        ZstdDCtx(ZstdDCtx&& o) noexcept : ctx(std::exchange(o.ctx, nullptr)), maxSize(o.maxSize) {}
+        ZstdDCtx& operator=(ZstdDCtx&& o) noexcept {
+            std::swap(ctx, o.ctx);
+            std::swap(maxSize, o.maxSize);
+            return *this;
+        }
+        ~ZstdDCtx() {
+            if (ctx) {
+                ZSTD_freeDCtx(ctx);
+            }
+        }
+
+        // dict 为空 则不使用字典. 帧头 无 内容长度 则 流式解压
+        void Decompress(std::string_view const& src, Data& dst, ZstdDict const* dict = {}) {
+            auto siz = ZSTD_getFrameContentSize(src.data(), src.size());
+            if (ZSTD_CONTENTSIZE_ERROR == siz) throw std::logic_error("ZstdDCtx read content size error.");
+            if (ZSTD_CONTENTSIZE_UNKNOWN == siz) {
+                DecompressStream(src, dst, dict);
+                return;
+            }
+            if (siz > maxSize) throw std::logic_error("ZstdDCtx decompress error: content size > maxSize.");
+            if (0 == siz) return;
+            dst.Reserve(dst.len + siz);
+            size_t r;
+            if (dict) {
+                assert(*dict);
+                r = ZSTD_decompress_usingDDict(ctx, dst.buf + dst.len, siz, src.data(), src.size(), dict->ddict);
+            } else {
+                r = ZSTD_decompressDCtx(ctx, dst.buf + dst.len, siz, src.data(), src.size());
+            }
+            if (ZSTD_isError(r)) throw std::logic_error("ZstdDCtx decompress error.");
+            dst.len += r;
+        }
+
+        // 按块 扩容 解压, 总长 超过 maxSize 抛异常( dst 恢复原长 )
+        void DecompressStream(std::string_view const& src, Data& dst, ZstdDict const* dict = {}) {
+            auto base = dst.len;
+            auto fail = [&](char const* msg) {
+                ZSTD_DCtx_refDDict(ctx, nullptr);       // 一次性 解压 函数 也会用到 引用的 字典
+                dst.len = base;
+                throw std::logic_error(msg);
+            };
+            ZSTD_DCtx_reset(ctx, ZSTD_reset_session_only);
+            if (dict) {
+                assert(*dict);
+                ZSTD_DCtx_refDDict(ctx, dict->ddict);
+            }
+            ZSTD_inBuffer in{ src.data(), src.size(), 0 };
+            ZSTD_outBuffer o;
+            size_t r;
+            do {
+                dst.Reserve(dst.len + ZSTD_DStreamOutSize());
+                o = { dst.buf + dst.len, dst.cap - dst.len, 0 };
+                r = ZSTD_decompressStream(ctx, &o, &in);
+                if (ZSTD_isError(r)) fail("ZstdDCtx decompress stream error.");
+                dst.len += o.pos;
+                if (dst.len - base > maxSize) fail("ZstdDCtx decompress error: content size > maxSize.");
+            } while (r && (in.pos < in.size || o.pos == o.size));
+            if (r) fail("ZstdDCtx decompress stream error: incomplete frame.");
+            if (dict) {
+                ZSTD_DCtx_refDDict(ctx, nullptr);
+            }
+        }
+
+        void Decompress(std::string_view const& src, Data& dst, ZstdDict const& dict) {
+            Decompress(src, dst, &dict);
+        }
+    };
+
 }